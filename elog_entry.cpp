@@ -5,6 +5,7 @@
 #include "log_manager.hpp"
 
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <unistd.h>
 
 #include <phosphor-logging/lg2.hpp>
@@ -18,7 +19,6 @@ namespace logging
 void Entry::persist()
 {
     serialize(*this);
-    serializeJSON(*this);
 }
 
 // TODO Add interfaces to handle the error log id numbering
@@ -109,16 +109,40 @@ std::string Entry::resolution(std::string value)
 
 sdbusplus::message::unix_fd Entry::getEntry()
 {
-    std::string jsonPath = path() + ".json";
-    int fd = open(jsonPath.c_str(), O_RDONLY | O_NONBLOCK);
+    // The JSON is only needed here, so render it on demand into an
+    // anonymous file instead of keeping a copy of it on flash.
+    auto json = renderJSON(*this);
+
+    int fd = memfd_create("phosphor-logging-entry", MFD_CLOEXEC);
     if (fd == -1)
     {
         auto e = errno;
-        lg2::error("Failed to open Entry File ERRNO={ERRNO}, PATH={PATH}",
-                   "ERRNO", e, "PATH", path());
+        lg2::error("Failed to create Entry File ERRNO={ERRNO}, ID={ID}",
+                   "ERRNO", e, "ID", id());
         throw sdbusplus::xyz::openbmc_project::Common::File::Error::Open();
     }
 
+    size_t written = 0;
+    while (written < json.size())
+    {
+        auto rc = write(fd, json.data() + written, json.size() - written);
+        if (rc < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            auto e = errno;
+            lg2::error("Failed to write Entry File ERRNO={ERRNO}, ID={ID}",
+                       "ERRNO", e, "ID", id());
+            close(fd);
+            throw sdbusplus::xyz::openbmc_project::Common::File::Error::Write();
+        }
+        written += rc;
+    }
+
+    lseek(fd, 0, SEEK_SET);
+
     // Schedule the fd to be closed by sdbusplus when it sends it back over
     // D-Bus.
     sdeventplus::Event event = sdeventplus::Event::get_default();
@@ -5,6 +5,9 @@
 #include "constants.hpp"
 #include "util.hpp"
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <cereal/archives/binary.hpp>
 #include <cereal/types/map.hpp>
 #include <cereal/types/string.hpp>
@@ -13,7 +16,10 @@
 #include <nlohmann/json.hpp>
 #include <phosphor-logging/lg2.hpp>
 
+#include <cstring>
 #include <fstream>
+#include <map>
+#include <sstream>
 
 // Register class version
 // From cereal documentation;
@@ -140,20 +146,247 @@ fs::path getEntrySerializePath(uint32_t id, const fs::path& dir)
     return dir / std::to_string(id);
 }
 
+/** @brief Return the temporary file a file is written to before being
+ *         renamed into place
+ *  @param[in] path - pathname of the file
+ *  @return fs::path - pathname of the temporary file
+ */
+static fs::path getTempPath(const fs::path& path)
+{
+    auto tmpPath = path.parent_path() / ('.' + path.filename().string());
+    tmpPath += ".tmp";
+    return tmpPath;
+}
+
+/** @brief Write the contents of a file
+ *  @param[in] path - pathname of the file to write
+ *  @param[in] data - the new file contents
+ *  @param[in] sync - if the data should be flushed to disk with fsync
+ *  @return bool - true if the file was written, false otherwise.
+ */
+static bool writeFile(const fs::path& path, const std::string& data,
+                      bool sync)
+{
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                  0644);
+    if (fd == -1)
+    {
+        lg2::error("Failed to create {PATH}: {ERROR}", "PATH", path, "ERROR",
+                   strerror(errno));
+        return false;
+    }
+
+    size_t written = 0;
+    while (written < data.size())
+    {
+        auto rc = write(fd, data.data() + written, data.size() - written);
+        if (rc < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        written += rc;
+    }
+
+    if ((written != data.size()) || (sync && (fsync(fd) != 0)))
+    {
+        lg2::error("Failed to write {PATH}: {ERROR}", "PATH", path, "ERROR",
+                   strerror(errno));
+        close(fd);
+        fs::remove(path);
+        return false;
+    }
+    close(fd);
+
+    return true;
+}
+
+/** @brief The number of renames into place done by this process that a
+ *         directory watch hasn't yet been told about, by pathname.
+ *
+ *  Only kept with REDUNDANT_BMC, where the error directory is watched for
+ *  files synced from the other BMC.  Everything runs on the event loop
+ *  thread, so it doesn't need a lock.
+ */
+static std::map<fs::path, size_t> ownRenames;
+
+bool isOwnRename(const fs::path& path)
+{
+    auto it = ownRenames.find(path);
+    if (it == ownRenames.end())
+    {
+        return false;
+    }
+
+    if (--it->second == 0)
+    {
+        ownRenames.erase(it);
+    }
+    return true;
+}
+
+/** @brief Rename a written temporary file over its final path
+ *  @param[in] tmpPath - pathname of the temporary file
+ *  @param[in] path - pathname to rename it to
+ *  @return bool - true if the file was renamed, false otherwise.
+ */
+static bool commitFile(const fs::path& tmpPath, const fs::path& path)
+{
+    std::error_code ec;
+    fs::rename(tmpPath, path, ec);
+    if (ec)
+    {
+        lg2::error("Failed to rename {TMP_PATH} to {PATH}: {ERROR}",
+                   "TMP_PATH", tmpPath, "PATH", path, "ERROR", ec.message());
+        fs::remove(tmpPath, ec);
+        return false;
+    }
+
+    if constexpr (REDUNDANT_BMC)
+    {
+        if (path.parent_path() == paths::error())
+        {
+            ownRenames[path]++;
+        }
+    }
+
+    return true;
+}
+
+/** @brief Sync a directory, so that renames into it are persisted
+ *  @param[in] dir - pathname of the directory
+ *
+ *  The file data is already synced, so a failure is only logged.
+ */
+static void syncDir(const fs::path& dir)
+{
+    int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if ((fd == -1) || (fsync(fd) != 0))
+    {
+        lg2::error("Failed to sync {DIR}: {ERROR}", "DIR", dir, "ERROR",
+                   strerror(errno));
+    }
+    if (fd != -1)
+    {
+        close(fd);
+    }
+}
+
+/** @brief Atomically replace the contents of a file
+ *  @param[in] path - pathname of the file to write
+ *  @param[in] data - the new file contents
+ *  @return bool - true if the file was written, false otherwise.
+ */
+static bool writeFileAtomic(const fs::path& path, const std::string& data)
+{
+    auto tmpPath = getTempPath(path);
+    if (!writeFile(tmpPath, data, true) || !commitFile(tmpPath, path))
+    {
+        return false;
+    }
+
+    syncDir(path.parent_path());
+    return true;
+}
+
+/** @brief Render error d-bus object in the Cereal binary format
+ *  @param[in] e - const reference to error entry.
+ *  @return std::string - the serialized data
+ */
+static std::string renderBinary(const Entry& e)
+{
+    std::ostringstream os(std::ios::binary);
+    {
+        cereal::BinaryOutputArchive oarchive(os);
+        oarchive(e);
+    }
+    return os.str();
+}
+
 fs::path serialize(const Entry& e, const fs::path& dir)
 {
     auto path = getEntrySerializePath(e.id(), dir);
-    std::ofstream os(path.c_str(), std::ios::binary);
-    cereal::BinaryOutputArchive oarchive(os);
-    oarchive(e);
+    if (!writeFileAtomic(path, renderBinary(e)))
+    {
+        lg2::error("Failed to persist event log {ID}", "ID", e.id());
+        return {};
+    }
     return path;
 }
 
-fs::path serializeJSON(const Entry& e, const fs::path& dir)
+std::vector<fs::path> serialize(const std::vector<const Entry*>& entries,
+                                const fs::path& dir)
 {
-    auto path = getEntrySerializePath(e.id(), dir);
-    path += ".json";
+    std::vector<fs::path> files(entries.size());
+    std::vector<size_t> written;
+    written.reserve(entries.size());
+
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        auto path = getEntrySerializePath(entries[i]->id(), dir);
+        if (writeFile(getTempPath(path), renderBinary(*entries[i]), false))
+        {
+            files[i] = path;
+            written.push_back(i);
+        }
+    }
 
+    // Flush all of the temporary files with one sync of the filesystem
+    // before any of them are renamed into place.
+    bool synced = false;
+    if (!written.empty())
+    {
+        int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        synced = (fd != -1) && (syncfs(fd) == 0);
+        if (!synced)
+        {
+            lg2::error("Failed to sync {DIR}: {ERROR}", "DIR", dir, "ERROR",
+                       strerror(errno));
+        }
+        if (fd != -1)
+        {
+            close(fd);
+        }
+    }
+
+    std::error_code ec;
+    for (auto i : written)
+    {
+        auto tmpPath = getTempPath(files[i]);
+        if (!synced)
+        {
+            fs::remove(tmpPath, ec);
+            files[i].clear();
+        }
+        else if (!commitFile(tmpPath, files[i]))
+        {
+            files[i].clear();
+        }
+    }
+
+    // Then sync the directory once for all of the renames.
+    if (synced)
+    {
+        syncDir(dir);
+    }
+
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        if (files[i].empty())
+        {
+            lg2::error("Failed to persist event log {ID}", "ID",
+                       entries[i]->id());
+        }
+    }
+
+    return files;
+}
+
+std::string renderJSON(const Entry& e)
+{
     nlohmann::json j;
     j["jsonVersion"] = JSON_FORMAT_VERSION;
     j["id"] = e.id();
@@ -175,8 +408,16 @@ fs::path serializeJSON(const Entry& e, const fs::path& dir)
     j["eventId"] = e.eventId();
     j["resolution"] = e.resolution();
 
+    return j.dump(4);
+}
+
+fs::path serializeJSON(const Entry& e, const fs::path& dir)
+{
+    auto path = getEntrySerializePath(e.id(), dir);
+    path += ".json";
+
     std::ofstream os(path.c_str());
-    os << j.dump(4);
+    os << renderJSON(e);
     return path;
 }
 
@@ -6,6 +6,8 @@
 #include "paths.hpp"
 
 #include <filesystem>
+#include <string>
+#include <vector>
 
 namespace phosphor
 {
@@ -15,14 +17,47 @@ namespace logging
 namespace fs = std::filesystem;
 
 /** @brief Serialize and persist error d-bus object
+ *  @details The data is written to a temporary file which is then renamed
+ *           over the previous version, so a crash can't leave a truncated
+ *           file behind.
  *  @param[in] a - const reference to error entry.
  *  @param[in] dir - pathname of directory where the serialized error will
  *                   be placed.
- *  @return fs::path - pathname of persisted error file
+ *  @return fs::path - pathname of persisted error file, or an empty path
+ *                     if it couldn't be written
  */
 fs::path serialize(const Entry& e,
                    const fs::path& dir = fs::path(paths::error()));
 
+/** @brief Serialize and persist a group of error d-bus objects
+ *  @details The same as serialize(), except that the data of all of the
+ *           entries is flushed to disk with a single sync, instead of one
+ *           per entry, before the files are renamed into place.
+ *  @param[in] entries - the error entries.
+ *  @param[in] dir - pathname of directory where the serialized errors will
+ *                   be placed.
+ *  @return std::vector<fs::path> - pathnames of persisted error files, with
+ *                                  an empty path for any that couldn't be
+ *                                  written
+ */
+std::vector<fs::path> serialize(const std::vector<const Entry*>& entries,
+                                const fs::path& dir = fs::path(paths::error()));
+
+/** @brief Says if a file was just renamed into place by serialize(), so
+ *         that a watch on its directory can ignore the event.
+ *  @details Only tracked when REDUNDANT_BMC is enabled.  Each rename is
+ *           only reported once.
+ *  @param[in] path - pathname of the file
+ *  @return bool - true if this process renamed the file into place
+ */
+bool isOwnRename(const fs::path& path);
+
+/** @brief Render error d-bus object as a JSON document
+ *  @param[in] e - const reference to error entry.
+ *  @return std::string - the JSON text
+ */
+std::string renderJSON(const Entry& e);
+
 /** @brief Serialize error d-bus object as JSON
  *  @param[in] e - const reference to error entry.
  *  @param[in] dir - pathname of directory where the JSON file will
@@ -23,6 +23,12 @@ DeleteFunctions& Extensions::getDeleteFunctions()
     return deleteFunctions;
 }
 
+DeleteManyFunctions& Extensions::getDeleteManyFunctions()
+{
+    static DeleteManyFunctions deleteManyFunctions{};
+    return deleteManyFunctions;
+}
+
 DeleteProhibitedFunctions& Extensions::getDeleteProhibitedFunctions()
 {
     static DeleteProhibitedFunctions deleteProhibitedFunctions{};
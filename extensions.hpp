@@ -4,6 +4,7 @@
 #include "log_manager.hpp"
 
 #include <functional>
+#include <set>
 #include <vector>
 
 namespace phosphor
@@ -42,6 +43,18 @@ using CreateFunction = std::function<void(
  */
 using DeleteFunction = std::function<void(uint32_t)>;
 
+/**
+ * @brief The function type that will be called after one or more event
+ *        logs are deleted.
+ *
+ * This is used in place of a DeleteFunction by extensions that can handle
+ * a batch of deletes more efficiently than one at a time, such as when
+ * all logs are deleted.  An extension should only register one of the two.
+ *
+ * @param[in] const std::set<uint32_t>& - The event log IDs
+ */
+using DeleteManyFunction = std::function<void(const std::set<uint32_t>&)>;
+
 /**
  * @brief The function type that will be used to check if an event log is
  * prohibited from being deleted.The same function is used to check if an event
@@ -75,6 +88,7 @@ using ExtensionLogAssociation =
 using StartupFunctions = std::vector<StartupFunction>;
 using CreateFunctions = std::vector<CreateFunction>;
 using DeleteFunctions = std::vector<DeleteFunction>;
+using DeleteManyFunctions = std::vector<DeleteManyFunction>;
 using DeleteProhibitedFunctions = std::vector<DeleteProhibitedFunction>;
 using ExtensionLogAssociations = std::vector<ExtensionLogAssociation>;
 
@@ -167,6 +181,19 @@ class Extensions
         getDeleteFunctions().push_back(func);
     }
 
+    /**
+     * @brief Constructor to register a delete many function
+     *
+     * Functions registered with this constructor will be called
+     * after phosphor-log-manager deletes one or more event logs.
+     *
+     * @param[in] func - The delete many function to register
+     */
+    explicit Extensions(DeleteManyFunction func)
+    {
+        getDeleteManyFunctions().push_back(func);
+    }
+
     /**
      * @brief Constructor to register a delete prohibition function
      *
@@ -240,6 +267,12 @@ class Extensions
      */
     static DeleteFunctions& getDeleteFunctions();
 
+    /**
+     * @brief Returns the DeleteMany functions
+     * @return DeleteManyFunctions - the DeleteMany functions
+     */
+    static DeleteManyFunctions& getDeleteManyFunctions();
+
     /**
      * @brief Returns the DeleteProhibited functions
      * @return DeleteProhibitedFunctions - the DeleteProhibited functions
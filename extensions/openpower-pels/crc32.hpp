@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace openpower
+{
+namespace pels
+{
+
+/**
+ * @brief Calculates a CRC-32 (IEEE 802.3) of the data.
+ *
+ * @param[in] data - The data
+ * @param[in] size - The size of the data
+ *
+ * @return uint32_t - The CRC
+ */
+inline uint32_t crc32(const uint8_t* data, size_t size)
+{
+    static const auto table = []() {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < t.size(); i++)
+        {
+            uint32_t c = i;
+            for (int bit = 0; bit < 8; bit++)
+            {
+                c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < size; i++)
+    {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+
+    return crc ^ 0xFFFFFFFF;
+}
+
+} // namespace pels
+} // namespace openpower
@@ -69,6 +69,8 @@ constexpr auto chassisState = "xyz.openbmc_project.State.Chassis";
 constexpr auto hostState = "xyz.openbmc_project.State.Host";
 constexpr auto viniRecordVPD = "com.ibm.ipzvpd.VINI";
 constexpr auto vsbpRecordVPD = "com.ibm.ipzvpd.VSBP";
+constexpr auto vcenRecordVPD = "com.ibm.ipzvpd.VCEN";
+constexpr auto vsysRecordVPD = "com.ibm.ipzvpd.VSYS";
 constexpr auto locCode = "xyz.openbmc_project.Inventory.Decorator.LocationCode";
 constexpr auto compatible =
     "xyz.openbmc_project.Inventory.Decorator.Compatible";
@@ -97,6 +99,13 @@ namespace match_rules = sdbusplus::match_rules;
 
 const DBusInterfaceList hotplugInterfaces{interface::invFan,
                                           interface::invPowerSupply};
+
+// The interfaces whose property changes make the inventory lookup
+// caches stale.  Includes the system VPD used to expand location codes.
+const DBusInterfaceList lookupCacheInterfaces{
+    interface::viniRecordVPD, interface::locCode, interface::invItem,
+    interface::vcenRecordVPD, interface::vsysRecordVPD};
+
 static constexpr auto PDBG_DTB_PATH =
     "/var/lib/phosphor-software-manager/hostfw/running/DEVTREE";
 
@@ -194,6 +203,13 @@ DataInterface::DataInterface(sdbusplus::bus_t& bus) :
             this->_hostState = std::get<std::string>(value);
         }));
 
+    // Watch the QuiesceOnHwError setting
+    _properties.emplace_back(std::make_unique<PropertyWatcher<DataInterface>>(
+        bus, object_path::logSetting, interface::logSetting,
+        "QuiesceOnHwError", *this, [this](const auto& value) {
+            this->_quiesceOnHwError = std::get<bool>(value);
+        }));
+
     // Watch the BaseBIOSTable property for the hmc managed attribute
     _properties.emplace_back(std::make_unique<PropertyWatcher<DataInterface>>(
         bus, object_path::biosConfigMgr, interface::biosConfigMgr,
@@ -214,6 +230,8 @@ DataInterface::DataInterface(sdbusplus::bus_t& bus) :
             }
         }));
 
+    startInventoryCacheWatch();
+
     if (isPHALDevTreeExist())
     {
 #ifdef PEL_ENABLE_PHAL
@@ -228,6 +246,15 @@ DataInterface::DataInterface(sdbusplus::bus_t& bus) :
     }
 }
 
+DataInterface::~DataInterface()
+{
+    for (const auto& [name, stats] : getLookupCacheStats())
+    {
+        lg2::info("{NAME} lookup cache hits: {HITS} misses: {MISSES}", "NAME",
+                  name, "HITS", stats.hits, "MISSES", stats.misses);
+    }
+}
+
 DBusPropertyMap DataInterface::getAllProperties(
     const std::string& service, const std::string& objectPath,
     const std::string& interface) const
@@ -425,6 +452,12 @@ void DataInterface::getHWCalloutFields(
     // will provide this info.  Any missing interfaces will result
     // in exceptions being thrown.
 
+    if (auto fields = _hwCalloutFieldsCache.get(inventoryPath); fields)
+    {
+        std::tie(fruPartNumber, ccin, serialNumber) = *fields;
+        return;
+    }
+
     auto service = getService(inventoryPath, interface::viniRecordVPD);
 
     auto properties =
@@ -438,17 +471,27 @@ void DataInterface::getHWCalloutFields(
 
     value = std::get<std::vector<uint8_t>>(properties["SN"]);
     serialNumber = std::string{value.begin(), value.end()};
+
+    _hwCalloutFieldsCache.insert(inventoryPath,
+                                 {fruPartNumber, ccin, serialNumber});
 }
 
 std::string DataInterface::getLocationCode(
     const std::string& inventoryPath) const
 {
+    if (auto cached = _locationCodeCache.get(inventoryPath); cached)
+    {
+        return *cached;
+    }
+
     auto service = getService(inventoryPath, interface::locCode);
 
     DBusValue locCode;
     getProperty(service, inventoryPath, interface::locCode, "LocationCode",
                 locCode);
 
+    _locationCodeCache.insert(inventoryPath, std::get<std::string>(locCode));
+
     return std::get<std::string>(locCode);
 }
 
@@ -470,6 +513,11 @@ std::string DataInterface::addLocationCodePrefix(
 std::string DataInterface::expandLocationCode(const std::string& locationCode,
                                               uint16_t /*node*/) const
 {
+    if (auto cached = _expandedLocCodeCache.get(locationCode); cached)
+    {
+        return *cached;
+    }
+
     // Location codes for connectors are the location code of the FRU they are
     // on, plus a '-Tx' segment.  Remove this last segment before expanding it
     // and then add it back in afterwards.  This way, the connector doesn't have
@@ -491,12 +539,23 @@ std::string DataInterface::expandLocationCode(const std::string& locationCode,
         expandedLocationCode += connectorLoc;
     }
 
+    _expandedLocCodeCache.insert(locationCode, expandedLocationCode);
+
     return expandedLocationCode;
 }
 
 std::vector<std::string> DataInterface::getInventoryFromLocCode(
     const std::string& locationCode, uint16_t node, bool expanded) const
 {
+    // The node isn't used with an expanded location code.
+    std::tuple<std::string, uint16_t, bool> key{
+        locationCode, static_cast<uint16_t>(expanded ? 0 : node), expanded};
+
+    if (auto cached = _inventoryFromLocCodeCache.get(key); cached)
+    {
+        return *cached;
+    }
+
     std::string methodName = expanded ? "GetFRUsByExpandedLocationCode"
                                       : "GetFRUsByUnexpandedLocationCode";
 
@@ -529,6 +588,8 @@ std::vector<std::string> DataInterface::getInventoryFromLocCode(
     std::for_each(entries.begin(), entries.end(),
                   [&paths](const auto& path) { paths.push_back(path); });
 
+    _inventoryFromLocCodeCache.insert(key, paths);
+
     return paths;
 }
 
@@ -627,6 +688,11 @@ std::vector<std::string> DataInterface::getSystemNames() const
 
 bool DataInterface::getQuiesceOnError() const
 {
+    if (_quiesceOnHwError)
+    {
+        return *_quiesceOnHwError;
+    }
+
     bool ret = false;
 
     try
@@ -640,6 +706,7 @@ bool DataInterface::getQuiesceOnError() const
                         "QuiesceOnHwError", value);
 
             ret = std::get<bool>(value);
+            _quiesceOnHwError = ret;
         }
     }
     catch (const std::exception& e)
@@ -998,6 +1065,10 @@ void DataInterface::notifyPresenceSubscribers(const std::string& path,
         return;
     }
 
+    // A new FRU may have been plugged in, so don't use any cached
+    // data for it.  This may run before the inventory cache watch.
+    invalidateLookupCaches(path);
+
     std::string locCode;
 
     try
@@ -1027,6 +1098,69 @@ void DataInterface::notifyPresenceSubscribers(const std::string& path,
     setFruPresent(locCode);
 }
 
+void DataInterface::startInventoryCacheWatch()
+{
+    _invCacheMatches.emplace_back(std::make_unique<sdbusplus::match>(
+        _bus, match_rules::interfacesAdded(object_path::baseInv),
+        std::bind(&DataInterface::inventoryIfacesChanged, this,
+                  std::placeholders::_1)));
+
+    _invCacheMatches.emplace_back(std::make_unique<sdbusplus::match>(
+        _bus, match_rules::interfacesRemoved(object_path::baseInv),
+        std::bind(&DataInterface::inventoryIfacesChanged, this,
+                  std::placeholders::_1)));
+
+    _invCacheMatches.emplace_back(std::make_unique<sdbusplus::match>(
+        _bus,
+        match_rules::type::signal() + match_rules::member("PropertiesChanged") +
+            match_rules::interface(interface::dbusProperty) +
+            match_rules::path_namespace(object_path::baseInv),
+        std::bind(&DataInterface::inventoryPropertiesChanged, this,
+                  std::placeholders::_1)));
+}
+
+void DataInterface::inventoryIfacesChanged(sdbusplus::message_t& msg)
+{
+    sdbusplus::object_path path;
+    msg.read(path);
+
+    invalidateLookupCaches(path.str);
+}
+
+void DataInterface::inventoryPropertiesChanged(sdbusplus::message_t& msg)
+{
+    DBusInterface interface;
+    msg.read(interface);
+
+    if (std::ranges::find(lookupCacheInterfaces, interface) !=
+        lookupCacheInterfaces.end())
+    {
+        invalidateLookupCaches(msg.get_path());
+    }
+}
+
+void DataInterface::invalidateLookupCaches(const std::string& path)
+{
+    _locationCodeCache.erase(path);
+    _hwCalloutFieldsCache.erase(path);
+    _expandedLocCodeCache.clear();
+    _inventoryFromLocCodeCache.clear();
+}
+
+std::map<std::string, DataInterface::LookupCacheStats>
+    DataInterface::getLookupCacheStats() const
+{
+    return {{"getLocationCode",
+             {_locationCodeCache.hits(), _locationCodeCache.misses()}},
+            {"getHWCalloutFields",
+             {_hwCalloutFieldsCache.hits(), _hwCalloutFieldsCache.misses()}},
+            {"expandLocationCode",
+             {_expandedLocCodeCache.hits(), _expandedLocCodeCache.misses()}},
+            {"getInventoryFromLocCode",
+             {_inventoryFromLocCodeCache.hits(),
+              _inventoryFromLocCodeCache.misses()}}};
+}
+
 bool DataInterface::isPHALDevTreeExist() const
 {
     try
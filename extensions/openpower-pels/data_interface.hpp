@@ -2,6 +2,7 @@
 
 #include "dbus_types.hpp"
 #include "dbus_watcher.hpp"
+#include "lru_cache.hpp"
 
 #ifdef PEL_ENABLE_PHAL
 #include <libguard/guard_interface.hpp>
@@ -14,6 +15,7 @@
 
 #include <filesystem>
 #include <fstream>
+#include <tuple>
 #include <unordered_map>
 
 #ifdef PEL_ENABLE_PHAL
@@ -694,7 +696,7 @@ class DataInterface : public DataInterfaceBase
 {
   public:
     DataInterface() = delete;
-    ~DataInterface() override = default;
+    ~DataInterface() override;
     DataInterface(const DataInterface&) = delete;
     DataInterface& operator=(const DataInterface&) = delete;
     DataInterface(DataInterface&&) = delete;
@@ -860,6 +862,9 @@ class DataInterface : public DataInterfaceBase
     /**
      * @brief Returns the manufacturing QuiesceOnError property
      *
+     * The value is cached, and only read from D-Bus if the property
+     * watcher hasn't provided it yet.
+     *
      * @return bool - Manufacturing QuiesceOnError property
      */
     bool getQuiesceOnError() const override;
@@ -944,6 +949,26 @@ class DataInterface : public DataInterfaceBase
     std::optional<std::pair<bool, std::string>> getBMCRedundancyFields()
         const override;
 
+    /**
+     * @brief The hit and miss counts of an inventory lookup cache.
+     */
+    struct LookupCacheStats
+    {
+        size_t hits;
+        size_t misses;
+    };
+
+    /**
+     * @brief Returns the hit and miss counts of the caches used by
+     *        getLocationCode(), getHWCalloutFields(),
+     *        expandLocationCode(), and getInventoryFromLocCode(), where
+     *        every miss is a lookup that had to go to D-Bus.
+     *
+     * @return std::map<std::string, LookupCacheStats> - The counts,
+     *         by method name
+     */
+    std::map<std::string, LookupCacheStats> getLookupCacheStats() const;
+
   private:
     /**
      * @brief Reads the BMC firmware version string and puts it into
@@ -1033,6 +1058,41 @@ class DataInterface : public DataInterfaceBase
     void notifyPresenceSubscribers(const std::string& path,
                                    const DBusPropertyMap& properties);
 
+    /**
+     * @brief Start watching the inventory for changes that make the
+     *        entries in the inventory lookup caches stale.
+     */
+    void startInventoryCacheWatch();
+
+    /**
+     * @brief Callback when inventory interfaces are added or removed,
+     *        which invalidates the cached lookups for that object.
+     *
+     * @param[in] msg - The InterfacesAdded or InterfacesRemoved signal
+     *                  contents.
+     */
+    void inventoryIfacesChanged(sdbusplus::message_t& msg);
+
+    /**
+     * @brief Callback when properties change on an inventory object,
+     *        which invalidates the cached lookups for it if they are
+     *        on an interface those lookups use.
+     *
+     * @param[in] msg - The PropertiesChanged signal contents.
+     */
+    void inventoryPropertiesChanged(sdbusplus::message_t& msg);
+
+    /**
+     * @brief Removes the cached lookups for an inventory object.
+     *
+     * Since a change on one object can change which object a location
+     * code maps to, and the location code expansion, the caches keyed
+     * by location code are cleared too.
+     *
+     * @param[in] path - The inventory object path
+     */
+    void invalidateLookupCaches(const std::string& path);
+
     /**
      * @brief Adds the Ufcs- prefix to the location code passed in
      *        if necessary.
@@ -1084,6 +1144,51 @@ class DataInterface : public DataInterfaceBase
      */
     std::vector<std::unique_ptr<DBusWatcher>> _properties;
 
+    /**
+     * @brief The QuiesceOnHwError setting, kept up to date by a
+     *        property watcher.  Empty until it has been read.
+     */
+    mutable std::optional<bool> _quiesceOnHwError;
+
+    /**
+     * @brief The maximum number of entries in each inventory lookup
+     *        cache.
+     */
+    static constexpr size_t lookupCacheSize = 64;
+
+    /**
+     * @brief Location codes by inventory path.
+     */
+    mutable LRUCache<std::string, std::string> _locationCodeCache{
+        lookupCacheSize};
+
+    /**
+     * @brief The FN, CC, and SN keywords by inventory path.
+     */
+    mutable LRUCache<std::string,
+                     std::tuple<std::string, std::string, std::string>>
+        _hwCalloutFieldsCache{lookupCacheSize};
+
+    /**
+     * @brief Expanded location codes by unexpanded location code.
+     */
+    mutable LRUCache<std::string, std::string> _expandedLocCodeCache{
+        lookupCacheSize};
+
+    /**
+     * @brief Inventory paths by location code, node, and if the
+     *        location code is expanded.
+     */
+    mutable LRUCache<std::tuple<std::string, uint16_t, bool>,
+                     std::vector<std::string>>
+        _inventoryFromLocCodeCache{lookupCacheSize};
+
+    /**
+     * @brief The matches for inventory changes that invalidate the
+     *        lookup caches.
+     */
+    std::vector<std::unique_ptr<sdbusplus::match>> _invCacheMatches;
+
     std::unique_ptr<sdbusplus::match> _invIaMatch;
 
     /**
@@ -59,9 +59,9 @@ void pelCreate(const std::string& message, uint32_t id, uint64_t timestamp,
 
 REGISTER_EXTENSION_FUNCTION(pelCreate)
 
-void pelDelete(uint32_t id)
+void pelDelete(const std::set<uint32_t>& ids)
 {
-    return manager->erase(id);
+    return manager->erase(ids);
 }
 
 REGISTER_EXTENSION_FUNCTION(pelDelete)
@@ -0,0 +1,186 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <optional>
+#include <utility>
+
+namespace openpower
+{
+namespace pels
+{
+
+/**
+ * @class LRUCache
+ *
+ * A map that holds at most a fixed number of entries.  When a new
+ * entry is added to a full cache the least recently used entry is
+ * evicted.
+ *
+ * It also counts the lookups that did and didn't find an entry, so
+ * the benefit of the cache can be seen.
+ */
+template <typename Key, typename Value>
+class LRUCache
+{
+  public:
+    LRUCache() = delete;
+    ~LRUCache() = default;
+    LRUCache(const LRUCache&) = delete;
+    LRUCache& operator=(const LRUCache&) = delete;
+    LRUCache(LRUCache&&) = delete;
+    LRUCache& operator=(LRUCache&&) = delete;
+
+    /**
+     * @brief Constructor
+     *
+     * @param[in] capacity - The maximum number of entries
+     */
+    explicit LRUCache(size_t capacity) : _capacity(capacity) {}
+
+    /**
+     * @brief Looks up an entry, making it the most recently used one.
+     *
+     * @param[in] key - The key
+     *
+     * @return std::optional<Value> - The value, or std::nullopt if
+     *                                it isn't in the cache
+     */
+    std::optional<Value> get(const Key& key)
+    {
+        auto it = _index.find(key);
+        if (it == _index.end())
+        {
+            _misses++;
+            return std::nullopt;
+        }
+
+        _hits++;
+        _entries.splice(_entries.begin(), _entries, it->second);
+        return it->second->second;
+    }
+
+    /**
+     * @brief Adds or replaces an entry, making it the most recently
+     *        used one.
+     *
+     * @param[in] key - The key
+     * @param[in] value - The value
+     */
+    void insert(const Key& key, Value value)
+    {
+        if (auto it = _index.find(key); it != _index.end())
+        {
+            it->second->second = std::move(value);
+            _entries.splice(_entries.begin(), _entries, it->second);
+            return;
+        }
+
+        if (_capacity == 0)
+        {
+            return;
+        }
+
+        if (_entries.size() >= _capacity)
+        {
+            _index.erase(_entries.back().first);
+            _entries.pop_back();
+        }
+
+        _entries.emplace_front(key, std::move(value));
+        _index.emplace(key, _entries.begin());
+    }
+
+    /**
+     * @brief Removes an entry.
+     *
+     * @param[in] key - The key
+     *
+     * @return bool - If the entry was there
+     */
+    bool erase(const Key& key)
+    {
+        auto it = _index.find(key);
+        if (it == _index.end())
+        {
+            return false;
+        }
+
+        _entries.erase(it->second);
+        _index.erase(it);
+        return true;
+    }
+
+    /**
+     * @brief Removes all entries.  The counters aren't reset.
+     */
+    void clear()
+    {
+        _entries.clear();
+        _index.clear();
+    }
+
+    /**
+     * @brief Returns the number of entries.
+     *
+     * @return size_t - The number of entries
+     */
+    size_t size() const
+    {
+        return _entries.size();
+    }
+
+    /**
+     * @brief Returns the number of lookups that found an entry.
+     *
+     * @return size_t - The hit count
+     */
+    size_t hits() const
+    {
+        return _hits;
+    }
+
+    /**
+     * @brief Returns the number of lookups that didn't find an entry.
+     *
+     * @return size_t - The miss count
+     */
+    size_t misses() const
+    {
+        return _misses;
+    }
+
+  private:
+    using Entry = std::pair<Key, Value>;
+
+    /**
+     * @brief The maximum number of entries.
+     */
+    const size_t _capacity;
+
+    /**
+     * @brief The entries, most recently used first.
+     */
+    std::list<Entry> _entries;
+
+    /**
+     * @brief The position of each entry in _entries, by key.
+     */
+    std::map<Key, typename std::list<Entry>::iterator> _index;
+
+    /**
+     * @brief The number of lookups that found an entry.
+     */
+    size_t _hits = 0;
+
+    /**
+     * @brief The number of lookups that didn't find an entry.
+     */
+    size_t _misses = 0;
+};
+
+} // namespace pels
+} // namespace openpower
@@ -52,8 +52,13 @@ constexpr auto defaultLogMessage = "xyz.openbmc_project.Logging.Error.Default";
 constexpr uint32_t bmcThermalCompID = 0x2700;
 constexpr uint32_t bmcFansCompID = 0x2800;
 
+// How long new PELs wait to be synced to disk together.
+constexpr std::chrono::milliseconds repoSyncDelay{100};
+
 Manager::~Manager()
 {
+    _repo.sync();
+
     if (_pelDirWatchFD != -1)
     {
         if (_pelDirWatcherWD != -1)
@@ -160,6 +165,7 @@ void Manager::addPEL(std::vector<uint8_t>& pelData, uint32_t obmcLogID)
                     "ID", lg2::hex, pel->id());
 
                 _repo.archivePEL(*pel);
+                scheduleRepoSync();
 
                 // No need to keep around the openBMC event log entry
                 scheduleObmcLogDelete(obmcLogID);
@@ -178,6 +184,7 @@ void Manager::addPEL(std::vector<uint8_t>& pelData, uint32_t obmcLogID)
             lg2::debug("Adding external PEL {ID} (BMC ID {BMCID}) to repo",
                        "ID", lg2::hex, pel->id(), "BMCID", obmcLogID);
             _repo.add(pel);
+            scheduleRepoSync();
 
             if (_repo.sizeWarning())
             {
@@ -291,13 +298,20 @@ std::vector<uint8_t> Manager::eselToRawData(const std::string& esel)
     return data;
 }
 
-void Manager::erase(uint32_t obmcLogID)
+void Manager::erase(const std::set<uint32_t>& obmcLogIDs)
 {
-    Repository::LogID id{Repository::LogID::Obmc(obmcLogID)};
+    std::vector<Repository::LogID> ids;
+    ids.reserve(obmcLogIDs.size());
+
+    for (auto obmcLogID : obmcLogIDs)
+    {
+        auto path = std::string(OBJ_ENTRY) + '/' + std::to_string(obmcLogID);
+        _pelEntries.erase(path);
+        ids.emplace_back(Repository::LogID::Obmc(obmcLogID));
+    }
 
-    auto path = std::string(OBJ_ENTRY) + '/' + std::to_string(obmcLogID);
-    _pelEntries.erase(path);
-    _repo.remove(id);
+    _repo.remove(ids);
+    scheduleRepoCompaction();
 }
 
 void Manager::getLogIDWithHwIsolation(std::vector<uint32_t>& idsWithHwIsoEntry)
@@ -401,6 +415,7 @@ void Manager::createPEL(
         *_journal);
 
     _repo.add(pel);
+    scheduleRepoSync();
 
     if (_repo.sizeWarning())
     {
@@ -566,9 +581,42 @@ void Manager::pruneRepo(sdeventplus::source::EventBase& /*source*/)
     std::for_each(idsToDelete.begin(), idsToDelete.end(),
                   [this](auto id) { this->_logManager.erase(id); });
 
+    scheduleRepoCompaction();
+
     _repoPrunerEventSource.reset();
 }
 
+void Manager::scheduleRepoCompaction()
+{
+    if (!_repoCompactorEventSource && _repo.compactionNeeded())
+    {
+        _repoCompactorEventSource =
+            std::make_unique<sdeventplus::source::Defer>(
+                _event, std::bind(std::mem_fn(&Manager::compactRepo), this,
+                                  std::placeholders::_1));
+    }
+}
+
+void Manager::compactRepo(sdeventplus::source::EventBase& /*source*/)
+{
+    _repo.compact();
+
+    _repoCompactorEventSource.reset();
+}
+
+void Manager::scheduleRepoSync()
+{
+    if (_repo.syncPending() && !_repoSyncTimer.isEnabled())
+    {
+        _repoSyncTimer.restartOnce(repoSyncDelay);
+    }
+}
+
+void Manager::syncRepo()
+{
+    _repo.sync();
+}
+
 void Manager::setupPELFileWatch()
 {
     auto pelDir = _repo.repoPath();
@@ -1000,7 +1048,6 @@ void Manager::serializeLogEntry(uint32_t obmcLogID)
     if (entryN != _logManager.entries.end())
     {
         serialize(*entryN->second);
-        serializeJSON(*entryN->second);
     }
 }
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "config.h"
+
 #include "constants.hpp"
 #include "data_interface.hpp"
 #include "event_logger.hpp"
@@ -16,8 +18,11 @@
 #include <sdbusplus/server.hpp>
 #include <sdeventplus/event.hpp>
 #include <sdeventplus/source/event.hpp>
+#include <sdeventplus/utility/timer.hpp>
 #include <xyz/openbmc_project/Logging/Create/server.hpp>
 
+#include <set>
+
 namespace openpower
 {
 namespace pels
@@ -51,11 +56,18 @@ class Manager : public PELInterface
             EventLogger::LogFunction creatorFunc,
             std::unique_ptr<JournalBase> journal) :
         PELInterface(logManager.getBus(), OBJ_LOGGING), _logManager(logManager),
-        _eventLogger(std::move(creatorFunc)), _repo(getPELRepoPath()),
+        _eventLogger(std::move(creatorFunc)),
+        _repo(getPELRepoPath(), getPELRepoSize(), getMaxNumPELs(),
+              PEL_SEGMENT_STORE ? Repository::Storage::segments
+                                : Repository::Storage::files),
         _registry(getPELReadOnlyDataPath() / message::registryFileName),
         _event(sdeventplus::Event::get_default()),
-        _dataIface(std::move(dataIface)), _journal(std::move(journal))
+        _dataIface(std::move(dataIface)), _journal(std::move(journal)),
+        _repoSyncTimer(_event, std::bind(std::mem_fn(&Manager::syncRepo), this))
     {
+        // New PELs are synced to disk together by syncRepo().
+        _repo.setGroupCommit(true);
+
         for (const auto& entry : _logManager.entries)
         {
             setEntryPath(entry.first);
@@ -118,11 +130,11 @@ class Manager : public PELInterface
                     phosphor::logging::FFDCEntries{});
 
     /**
-     * @brief Erase a PEL based on its OpenBMC event log ID
+     * @brief Erase the PELs for multiple OpenBMC event log IDs
      *
-     * @param[in] obmcLogID - the corresponding OpenBMC event log id
+     * @param[in] obmcLogIDs - the corresponding OpenBMC event log ids
      */
-    void erase(uint32_t obmcLogID);
+    void erase(const std::set<uint32_t>& obmcLogIDs);
 
     /**
      * @brief Get the list of event log ids that have an associated
@@ -398,6 +410,38 @@ class Manager : public PELInterface
      */
     void pruneRepo(sdeventplus::source::EventBase& source);
 
+    /**
+     * @brief Schedules reclaiming the space used by removed PELs in the
+     *        repository to occur from the event loop, if it is needed.
+     *
+     * Uses sd_event_add_defer
+     */
+    void scheduleRepoCompaction();
+
+    /**
+     * @brief Reclaims the space used by removed PELs in the repository.
+     *
+     * This is called from the event loop.
+     *
+     * @param[in] source - The event source object used
+     */
+    void compactRepo(sdeventplus::source::EventBase& source);
+
+    /**
+     * @brief Starts the timer to sync newly added PELs to disk, if it
+     *        isn't already running.
+     *
+     * All the PELs added before it expires share one sync.
+     */
+    void scheduleRepoSync();
+
+    /**
+     * @brief Syncs the newly added PELs to disk.
+     *
+     * This is called from the event loop when _repoSyncTimer expires.
+     */
+    void syncRepo();
+
     /**
      * @brief Sets up an inotify watch on the PEL directory.
      *
@@ -622,6 +666,12 @@ class Manager : public PELInterface
      */
     std::unique_ptr<JournalBase> _journal;
 
+    /**
+     * @brief The timer for syncing newly added PELs to disk.
+     */
+    sdeventplus::utility::Timer<sdeventplus::ClockId::Monotonic>
+        _repoSyncTimer;
+
     /**
      * @brief The map used to keep track of PEL entry pointer associated with
      *        event log.
@@ -649,6 +699,12 @@ class Manager : public PELInterface
      */
     std::unique_ptr<sdeventplus::source::Defer> _repoPrunerEventSource;
 
+    /**
+     * @brief The event source for compacting the repository after PELs
+     *        were removed.
+     */
+    std::unique_ptr<sdeventplus::source::Defer> _repoCompactorEventSource;
+
     /**
      * @brief The event source for deleting an OpenBMC event log.
      *        Used when its corresponding PEL is invalid.
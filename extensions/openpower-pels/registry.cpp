@@ -695,154 +695,269 @@ JournalCapture getJournalCapture(const nlohmann::json& json)
 std::optional<Entry> Registry::lookup(const std::string& name, LookupType type,
                                       bool toCache)
 {
-    std::optional<nlohmann::json> registryTmp;
-    auto& registryOpt = (_registry) ? _registry : registryTmp;
-    if (!registryOpt)
+    if (!load(!toCache))
     {
-        registryOpt = readRegistry(_registryFile);
-        if (!registryOpt)
-        {
-            return std::nullopt;
-        }
-        else if (toCache)
+        return std::nullopt;
+    }
+
+    const auto& index =
+        (type == LookupType::name) ? _nameIndex : _reasonCodeIndex;
+
+    if (auto it = index.find(name); it != index.end())
+    {
+        return _entries[it->second];
+    }
+
+    if (!_image)
+    {
+        return std::nullopt;
+    }
+
+    auto json = (type == LookupType::name) ? _image->findByName(name)
+                                           : _image->findByReasonCode(name);
+    if (!json)
+    {
+        return std::nullopt;
+    }
+
+    // Only this entry's JSON needs to be parsed.  Keep the result in
+    // _entries so it's only decoded the first time it's looked up.
+    try
+    {
+        auto pelEntry = nlohmann::json::parse(*json);
+        auto entry = parseEntry(pelEntry);
+        auto reasonCode =
+            pelEntry.at("SRC").at("ReasonCode").get<std::string>();
+
+        _nameIndex.emplace(entry.name, _entries.size());
+        _reasonCodeIndex.emplace(reasonCode, _entries.size());
+        _entries.push_back(std::move(entry));
+
+        return _entries.back();
+    }
+    catch (const std::exception& ex)
+    {
+        lg2::error("Found invalid message registry field. Error: {ERROR}",
+                   "ERROR", ex);
+        return std::nullopt;
+    }
+}
+
+bool Registry::load(bool checkForChanges)
+{
+    if (_loaded && !checkForChanges)
+    {
+        return true;
+    }
+
+    // Look in /etc first in case someone put a test file there, then
+    // use the image generated from the JSON at build time unless the
+    // JSON is newer.
+    fs::path file{fs::path{debugFilePath} / registryFileName};
+    bool useImage = false;
+    std::error_code ec;
+
+    if (!fs::exists(file, ec))
+    {
+        file = _registryFile;
+
+        auto image =
+            fs::path{_registryFile}.replace_extension(registryImageExtension);
+        auto imageTime = fs::last_write_time(image, ec);
+        if (!ec)
         {
-            // Save message registry in memory for peltool
-            _registry = std::move(registryTmp);
+            auto jsonTime = fs::last_write_time(_registryFile, ec);
+            if (ec || (imageTime >= jsonTime))
+            {
+                file = image;
+                useImage = true;
+            }
         }
     }
-    auto& reg = (_registry) ? _registry : registryTmp;
-    const auto& registry = reg.value();
-    // Find an entry with this name in the PEL array.
-    auto e = std::find_if(
-        registry["PELs"].begin(), registry["PELs"].end(),
-        [&name, &type](const nlohmann::json& j) {
-            return ((name == j.at("Name").get<std::string>() &&
-                     type == LookupType::name) ||
-                    (name == j.at("SRC").at("ReasonCode").get<std::string>() &&
-                     type == LookupType::reasonCode));
-        });
 
-    if (e != registry["PELs"].end())
+    auto writeTime = fs::last_write_time(file, ec);
+
+    if (_loaded && (file == _loadedFile) && !ec && (writeTime == _loadedTime))
     {
-        // Fill in the Entry structure from the JSON.  Most, but not all, fields
-        // are optional.
+        return true;
+    }
 
+    _loaded = false;
+    _image.reset();
+    _entries.clear();
+    _nameIndex.clear();
+    _reasonCodeIndex.clear();
+
+    if (useImage)
+    {
         try
         {
-            Entry entry;
-            entry.name = (*e)["Name"];
+            _image = std::make_shared<const RegistryImage>(file);
+            _loadedFile = file;
+            _loadedTime = writeTime;
+            _loaded = true;
+            return true;
+        }
+        catch (const std::exception& e)
+        {
+            // Still remember the image's time below, so this isn't
+            // tried again until the image changes.
+            lg2::error("Could not use message registry image, using the "
+                       "JSON. Error: {ERROR}",
+                       "ERROR", e);
+        }
+    }
 
-            if (e->contains("Subsystem"))
-            {
-                entry.subsystem = helper::getSubsystem((*e)["Subsystem"]);
-            }
+    auto registry = readRegistry(_registryFile);
+    if (!registry)
+    {
+        return false;
+    }
 
-            if (e->contains("ActionFlags"))
-            {
-                entry.actionFlags = helper::getActionFlags((*e)["ActionFlags"]);
-            }
+    // Decode every entry up front and index them by both name and
+    // reason code, so lookups don't need to search the JSON.
+    auto pels = registry->find("PELs");
+    if ((pels != registry->end()) && pels->is_array())
+    {
+        _entries.reserve(pels->size());
 
-            if (e->contains("MfgActionFlags"))
+        for (const auto& pelEntry : *pels)
+        {
+            try
             {
-                entry.mfgActionFlags =
-                    helper::getActionFlags((*e)["MfgActionFlags"]);
-            }
+                auto entry = parseEntry(pelEntry);
+                auto reasonCode =
+                    pelEntry.at("SRC").at("ReasonCode").get<std::string>();
 
-            if (e->contains("Severity"))
-            {
-                entry.severity = helper::getSeverities((*e)["Severity"]);
+                _nameIndex.emplace(entry.name, _entries.size());
+                _reasonCodeIndex.emplace(reasonCode, _entries.size());
+                _entries.push_back(std::move(entry));
             }
-
-            if (e->contains("MfgSeverity"))
+            catch (const std::exception& ex)
             {
-                entry.mfgSeverity = helper::getSeverities((*e)["MfgSeverity"]);
+                lg2::error(
+                    "Found invalid message registry field. Error: {ERROR}",
+                    "ERROR", ex);
             }
+        }
+    }
 
-            if (e->contains("EventType"))
-            {
-                entry.eventType = helper::getEventType((*e)["EventType"]);
-            }
+    _loadedFile = file;
+    _loadedTime = writeTime;
+    _loaded = true;
 
-            if (e->contains("EventScope"))
-            {
-                entry.eventScope = helper::getEventScope((*e)["EventScope"]);
-            }
+    return true;
+}
 
-            auto& src = (*e)["SRC"];
-            entry.src.reasonCode = helper::getSRCReasonCode(src, name);
+Entry Registry::parseEntry(const nlohmann::json& pelEntry) const
+{
+    // Fill in the Entry structure from the JSON.  Most, but not all, fields
+    // are optional.
+    Entry entry;
+    entry.name = pelEntry.at("Name");
 
-            if (src.contains("Type"))
-            {
-                entry.src.type = helper::getSRCType(src, name);
-            }
-            else
-            {
-                entry.src.type = static_cast<uint8_t>(SRCType::bmcError);
-            }
+    if (pelEntry.contains("Subsystem"))
+    {
+        entry.subsystem = helper::getSubsystem(pelEntry["Subsystem"]);
+    }
 
-            // Now that we know the SRC type and reason code,
-            // we can get the component ID.
-            entry.componentID = helper::getComponentID(
-                entry.src.type, entry.src.reasonCode, *e, name);
+    if (pelEntry.contains("ActionFlags"))
+    {
+        entry.actionFlags = helper::getActionFlags(pelEntry["ActionFlags"]);
+    }
 
-            if (src.contains("Words6To9"))
-            {
-                entry.src.hexwordADFields =
-                    helper::getSRCHexwordFields(src, name);
-            }
+    if (pelEntry.contains("MfgActionFlags"))
+    {
+        entry.mfgActionFlags =
+            helper::getActionFlags(pelEntry["MfgActionFlags"]);
+    }
 
-            if (src.contains("SymptomIDFields"))
-            {
-                entry.src.symptomID = helper::getSRCSymptomIDFields(src, name);
-            }
+    if (pelEntry.contains("Severity"))
+    {
+        entry.severity = helper::getSeverities(pelEntry["Severity"]);
+    }
 
-            if (src.contains("DeconfigFlag"))
-            {
-                entry.src.deconfigFlag = helper::getSRCDeconfigFlag(src);
-            }
+    if (pelEntry.contains("MfgSeverity"))
+    {
+        entry.mfgSeverity = helper::getSeverities(pelEntry["MfgSeverity"]);
+    }
 
-            if (src.contains("CheckstopFlag"))
-            {
-                entry.src.checkstopFlag = helper::getSRCCheckstopFlag(src);
-            }
+    if (pelEntry.contains("EventType"))
+    {
+        entry.eventType = helper::getEventType(pelEntry["EventType"]);
+    }
 
-            auto& doc = (*e)["Documentation"];
-            entry.doc.message = doc["Message"];
-            entry.doc.description = doc["Description"];
-            if (doc.contains("MessageArgSources"))
-            {
-                entry.doc.messageArgSources = doc["MessageArgSources"];
-            }
+    if (pelEntry.contains("EventScope"))
+    {
+        entry.eventScope = helper::getEventScope(pelEntry["EventScope"]);
+    }
 
-            // If there are callouts defined, save the JSON for later
-            if (_loadCallouts)
-            {
-                if (e->contains("Callouts"))
-                {
-                    entry.callouts = (*e)["Callouts"];
-                }
-                else if (e->contains("CalloutsUsingAD"))
-                {
-                    entry.callouts = (*e)["CalloutsUsingAD"];
-                }
-            }
+    auto& src = pelEntry["SRC"];
+    entry.src.reasonCode = helper::getSRCReasonCode(src, entry.name);
 
-            if (e->contains("JournalCapture"))
-            {
-                entry.journalCapture =
-                    helper::getJournalCapture((*e)["JournalCapture"]);
-            }
+    if (src.contains("Type"))
+    {
+        entry.src.type = helper::getSRCType(src, entry.name);
+    }
+    else
+    {
+        entry.src.type = static_cast<uint8_t>(SRCType::bmcError);
+    }
+
+    // Now that we know the SRC type and reason code,
+    // we can get the component ID.
+    entry.componentID = helper::getComponentID(
+        entry.src.type, entry.src.reasonCode, pelEntry, entry.name);
+
+    if (src.contains("Words6To9"))
+    {
+        entry.src.hexwordADFields =
+            helper::getSRCHexwordFields(src, entry.name);
+    }
+
+    if (src.contains("SymptomIDFields"))
+    {
+        entry.src.symptomID = helper::getSRCSymptomIDFields(src, entry.name);
+    }
 
-            return entry;
+    if (src.contains("DeconfigFlag"))
+    {
+        entry.src.deconfigFlag = helper::getSRCDeconfigFlag(src);
+    }
+
+    if (src.contains("CheckstopFlag"))
+    {
+        entry.src.checkstopFlag = helper::getSRCCheckstopFlag(src);
+    }
+
+    auto& doc = pelEntry["Documentation"];
+    entry.doc.message = doc["Message"];
+    entry.doc.description = doc["Description"];
+    if (doc.contains("MessageArgSources"))
+    {
+        entry.doc.messageArgSources = doc["MessageArgSources"];
+    }
+
+    // If there are callouts defined, save the JSON for later
+    if (_loadCallouts)
+    {
+        if (pelEntry.contains("Callouts"))
+        {
+            entry.callouts = pelEntry["Callouts"];
         }
-        catch (const std::exception& ex)
+        else if (pelEntry.contains("CalloutsUsingAD"))
         {
-            lg2::error("Found invalid message registry field. Error: {ERROR}",
-                       "ERROR", ex);
+            entry.callouts = pelEntry["CalloutsUsingAD"];
         }
     }
 
-    return std::nullopt;
+    if (pelEntry.contains("JournalCapture"))
+    {
+        entry.journalCapture =
+            helper::getJournalCapture(pelEntry["JournalCapture"]);
+    }
+
+    return entry;
 }
 
 std::optional<nlohmann::json> Registry::readRegistry(
@@ -1,11 +1,14 @@
 #pragma once
 #include "additional_data.hpp"
+#include "registry_image.hpp"
 
 #include <nlohmann/json.hpp>
 
 #include <filesystem>
+#include <memory>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
@@ -275,11 +278,18 @@ class Registry
      * but there is also an external program that enforces a schema on the
      * registry JSON that should catch all of these problems ahead of time.
      *
+     * If the binary image generated from the registry JSON at build time
+     * is present next to the JSON file, and there isn't a debug JSON file
+     * in /etc, the entry is found in the image and only its JSON is parsed.
+     * Otherwise the registry JSON is decoded and indexed on the first call.
+     * Either way it is reloaded if the file changes.
+     *
      * @param[in] name - The error name, like xyz.openbmc_project.Error.Foo
      *                 - OR
      *                 - The reason code, like 0x1001
      * @param[in] type - LookupType enum value
-     * @param[in] toCache - boolean to cache registry in memory
+     * @param[in] toCache - If true, don't check if the file changed once
+     *                      it has been loaded.
      * @return optional<Entry> A filled in message registry structure if
      *                         found, otherwise an empty optional object.
      */
@@ -322,9 +332,63 @@ class Registry
     std::filesystem::path _registryFile;
 
     /**
-     * @brief The full message registry object.
+     * @brief Loads the registry file into _entries and the indexes if
+     *        that hasn't been done yet, or optionally if the file has
+     *        changed since then.
+     *
+     * @param[in] checkForChanges - If the file should be reloaded if it
+     *                              changed since it was last loaded.
+     * @return bool - If the registry could be loaded
+     */
+    bool load(bool checkForChanges);
+
+    /**
+     * @brief Fills in an Entry structure from a PEL registry entry.
+     *
+     * Throws exceptions on invalid fields.
+     *
+     * @param[in] pelEntry - The JSON for the entry in the PELs array
+     * @return Entry - The filled in entry
+     */
+    Entry parseEntry(const nlohmann::json& pelEntry) const;
+
+    /**
+     * @brief The binary registry image, if one is being used instead
+     *        of the JSON.
+     */
+    std::shared_ptr<const RegistryImage> _image;
+
+    /**
+     * @brief The decoded registry entries.  When the JSON is used
+     *        they're all decoded on load, and when the image is used
+     *        each one is decoded the first time it's looked up.
+     */
+    std::vector<Entry> _entries;
+
+    /**
+     * @brief Error names to their index in _entries.
+     */
+    std::unordered_map<std::string, size_t> _nameIndex;
+
+    /**
+     * @brief Reason code strings, like 0x1001, to their index in _entries.
+     */
+    std::unordered_map<std::string, size_t> _reasonCodeIndex;
+
+    /**
+     * @brief The file that was loaded, which may be the debug file.
+     */
+    std::filesystem::path _loadedFile;
+
+    /**
+     * @brief The modification time of the file when it was loaded.
+     */
+    std::filesystem::file_time_type _loadedTime;
+
+    /**
+     * @brief If the registry has been loaded.
      */
-    std::optional<nlohmann::json> _registry;
+    bool _loaded = false;
 
     /**
      * @brief If the callout JSON should be saved in the Entry on lookup.
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+
+import argparse
+import json
+import struct
+
+r"""
+Compiles the PEL message registry JSON into a binary image that the PEL
+code can look entries up in without parsing the whole registry.
+
+The image layout, with all integers as little endian uint32s, is:
+
+    Header:
+        magic        - 8 bytes, 'PELREG' followed by the 2 byte version
+        num_entries  - The number of registry entries
+        name_table   - Offset of the table sorted by the Name field
+        rc_table     - Offset of the table sorted by the ReasonCode field
+        reserved     - 0
+
+    Tables, num_entries of:
+        key_offset, key_length, data_offset, data_length
+
+    Data:
+        The keys, and each entry's JSON in its most compact form.
+
+All offsets are from the start of the image.
+"""
+
+MAGIC = b"PELREG\x00\x01"
+HEADER_FORMAT = "<8sIIII"
+TABLE_ENTRY_FORMAT = "<IIII"
+
+
+def build_image(registry_json):
+    r"""
+    Returns the image bytes for the registry.
+
+    registry_json: The message registry JSON
+    """
+
+    entries = registry_json["PELs"]
+    num_entries = len(entries)
+
+    header_size = struct.calcsize(HEADER_FORMAT)
+    table_size = struct.calcsize(TABLE_ENTRY_FORMAT) * num_entries
+    name_table = header_size
+    rc_table = name_table + table_size
+
+    data = bytearray()
+    data_start = rc_table + table_size
+
+    def add_data(blob):
+        offset = data_start + len(data)
+        data.extend(blob)
+        return (offset, len(blob))
+
+    names = []
+    reason_codes = []
+    for entry in entries:
+        blob = add_data(
+            json.dumps(entry, separators=(",", ":")).encode("utf-8")
+        )
+        name = entry["Name"].encode("utf-8")
+        reason_code = entry["SRC"]["ReasonCode"].encode("utf-8")
+        names.append((name, add_data(name), blob))
+        reason_codes.append((reason_code, add_data(reason_code), blob))
+
+    image = bytearray(
+        struct.pack(HEADER_FORMAT, MAGIC, num_entries, name_table, rc_table, 0)
+    )
+
+    for table in (names, reason_codes):
+        for _, key, blob in sorted(table, key=lambda t: t[0]):
+            image.extend(struct.pack(TABLE_ENTRY_FORMAT, *key, *blob))
+
+    image.extend(data)
+    return bytes(image)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description="PEL message registry image generator"
+    )
+
+    parser.add_argument(
+        "-r",
+        "--registry-file",
+        dest="registry_file",
+        help="The message registry JSON file",
+        required=True,
+    )
+
+    parser.add_argument(
+        "-o",
+        "--output-file",
+        dest="output_file",
+        help="The image file to write",
+        required=True,
+    )
+
+    args = parser.parse_args()
+
+    with open(args.registry_file) as registry_handle:
+        registry_json = json.load(registry_handle)
+
+    with open(args.output_file, "wb") as output_handle:
+        output_handle.write(build_image(registry_json))
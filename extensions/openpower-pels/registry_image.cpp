@@ -0,0 +1,165 @@
+// SPDX-License-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: Copyright 2026 IBM Corporation
+
+#include "registry_image.hpp"
+
+#include <endian.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace openpower
+{
+namespace pels
+{
+namespace message
+{
+
+namespace
+{
+
+constexpr std::array<uint8_t, 8> imageMagic{'P', 'E', 'L', 'R',
+                                            'E', 'G', 0x00, 0x01};
+constexpr size_t headerSize = imageMagic.size() + 4 * sizeof(uint32_t);
+constexpr size_t tableEntrySize = 4 * sizeof(uint32_t);
+
+} // namespace
+
+RegistryImage::RegistryImage(const std::filesystem::path& imageFile)
+{
+    int fd = open(imageFile.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        throw std::runtime_error{"Could not open registry image " +
+                                 imageFile.string() + ": " +
+                                 strerror(errno)};
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0)
+    {
+        auto e = errno;
+        close(fd);
+        throw std::runtime_error{"Could not stat registry image " +
+                                 imageFile.string() + ": " + strerror(e)};
+    }
+
+    _size = st.st_size;
+    if (_size < headerSize)
+    {
+        close(fd);
+        throw std::runtime_error{"Registry image " + imageFile.string() +
+                                 " is too small"};
+    }
+
+    auto data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    auto e = errno;
+    close(fd);
+
+    if (data == MAP_FAILED)
+    {
+        throw std::runtime_error{"Could not map registry image " +
+                                 imageFile.string() + ": " + strerror(e)};
+    }
+
+    _data = static_cast<const uint8_t*>(data);
+
+    // Validate everything up front so lookups don't have to.
+    auto valid = [this]() {
+        if (std::memcmp(_data, imageMagic.data(), imageMagic.size()) != 0)
+        {
+            return false;
+        }
+
+        _numEntries = readUint32(imageMagic.size());
+        _nameTable = readUint32(imageMagic.size() + 4);
+        _reasonCodeTable = readUint32(imageMagic.size() + 8);
+
+        for (auto table : {_nameTable, _reasonCodeTable})
+        {
+            uint64_t tableEnd = table + uint64_t{_numEntries} * tableEntrySize;
+            if ((table < headerSize) || (tableEnd > _size))
+            {
+                return false;
+            }
+
+            for (uint32_t i = 0; i < _numEntries; i++)
+            {
+                size_t entry = table + i * tableEntrySize;
+                for (size_t field = 0; field < 4; field += 2)
+                {
+                    uint64_t offset = readUint32(entry + field * 4);
+                    uint64_t length = readUint32(entry + (field + 1) * 4);
+                    if (offset + length > _size)
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+
+        return true;
+    };
+
+    if (!valid())
+    {
+        munmap(const_cast<uint8_t*>(_data), _size);
+        throw std::runtime_error{"Registry image " + imageFile.string() +
+                                 " is not valid"};
+    }
+}
+
+RegistryImage::~RegistryImage()
+{
+    munmap(const_cast<uint8_t*>(_data), _size);
+}
+
+uint32_t RegistryImage::readUint32(size_t offset) const
+{
+    uint32_t value{};
+    std::memcpy(&value, _data + offset, sizeof(value));
+    return le32toh(value);
+}
+
+std::optional<std::string_view> RegistryImage::find(uint32_t tableOffset,
+                                                    std::string_view key) const
+{
+    // The generator sorted the table by the key bytes.
+    uint32_t low = 0;
+    uint32_t high = _numEntries;
+
+    while (low < high)
+    {
+        uint32_t mid = low + (high - low) / 2;
+        size_t entry = tableOffset + mid * tableEntrySize;
+
+        auto entryKey = view(readUint32(entry), readUint32(entry + 4));
+        auto result = entryKey.compare(key);
+
+        if (result == 0)
+        {
+            return view(readUint32(entry + 8), readUint32(entry + 12));
+        }
+
+        if (result < 0)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    return std::nullopt;
+}
+
+} // namespace message
+} // namespace pels
+} // namespace openpower
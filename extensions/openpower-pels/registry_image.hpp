@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+
+namespace openpower
+{
+namespace pels
+{
+namespace message
+{
+
+constexpr auto registryImageExtension = ".bin";
+
+/**
+ * @class RegistryImage
+ *
+ * Provides lookups into the binary message registry image that is
+ * generated at build time from the registry JSON by
+ * registry/tools/gen_registry_image.py.
+ *
+ * The image is mapped into memory and contains tables sorted by the
+ * entry names and reason codes, so an entry's JSON can be found
+ * without parsing anything else in the registry.
+ */
+class RegistryImage
+{
+  public:
+    RegistryImage() = delete;
+    RegistryImage(const RegistryImage&) = delete;
+    RegistryImage& operator=(const RegistryImage&) = delete;
+    RegistryImage(RegistryImage&&) = delete;
+    RegistryImage& operator=(RegistryImage&&) = delete;
+
+    /**
+     * @brief Constructor
+     *
+     * Maps the image file and validates its contents.
+     *
+     * Throws std::runtime_error if the file can't be used.
+     *
+     * @param[in] imageFile - The path to the image file
+     */
+    explicit RegistryImage(const std::filesystem::path& imageFile);
+
+    /**
+     * @brief Destructor
+     *
+     * Unmaps the file.
+     */
+    ~RegistryImage();
+
+    /**
+     * @brief Finds the JSON for a registry entry based on its name.
+     *
+     * @param[in] name - The error name, like xyz.openbmc_project.Error.Foo
+     *
+     * @return optional<std::string_view> - The entry JSON if found.  It
+     *         is valid for the lifetime of this object.
+     */
+    std::optional<std::string_view> findByName(std::string_view name) const
+    {
+        return find(_nameTable, name);
+    }
+
+    /**
+     * @brief Finds the JSON for a registry entry based on its reason code.
+     *
+     * @param[in] reasonCode - The reason code string, like 0x1001
+     *
+     * @return optional<std::string_view> - The entry JSON if found.  It
+     *         is valid for the lifetime of this object.
+     */
+    std::optional<std::string_view> findByReasonCode(
+        std::string_view reasonCode) const
+    {
+        return find(_reasonCodeTable, reasonCode);
+    }
+
+    /**
+     * @brief Returns the number of entries in the image.
+     *
+     * @return size_t - The number of entries
+     */
+    size_t size() const
+    {
+        return _numEntries;
+    }
+
+  private:
+    /**
+     * @brief Binary searches a table for the key.
+     *
+     * @param[in] tableOffset - The offset of the table in the image
+     * @param[in] key - The key to find
+     *
+     * @return optional<std::string_view> - The entry JSON if found
+     */
+    std::optional<std::string_view> find(uint32_t tableOffset,
+                                         std::string_view key) const;
+
+    /**
+     * @brief Returns the image contents at an offset.
+     *
+     * @param[in] offset - The offset into the image
+     * @param[in] length - The length
+     *
+     * @return std::string_view - The contents
+     */
+    std::string_view view(uint32_t offset, uint32_t length) const
+    {
+        return {reinterpret_cast<const char*>(_data) + offset, length};
+    }
+
+    /**
+     * @brief Reads a uint32_t out of the image.
+     *
+     * @param[in] offset - The offset into the image
+     *
+     * @return uint32_t - The value
+     */
+    uint32_t readUint32(size_t offset) const;
+
+    /**
+     * @brief The mapped image.
+     */
+    const uint8_t* _data = nullptr;
+
+    /**
+     * @brief The size of the image.
+     */
+    size_t _size = 0;
+
+    /**
+     * @brief The number of entries in the image.
+     */
+    uint32_t _numEntries = 0;
+
+    /**
+     * @brief The offset of the table sorted by name.
+     */
+    uint32_t _nameTable = 0;
+
+    /**
+     * @brief The offset of the table sorted by reason code.
+     */
+    uint32_t _reasonCodeTable = 0;
+};
+
+} // namespace message
+} // namespace pels
+} // namespace openpower
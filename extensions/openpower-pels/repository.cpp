@@ -3,15 +3,20 @@
 
 #include "repository.hpp"
 
+#include "crc32.hpp"
 #include "pel_values.hpp"
+#include "section_header.hpp"
 
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #include <phosphor-logging/lg2.hpp>
 #include <xyz/openbmc_project/Common/File/error.hpp>
 
+#include <array>
 #include <fstream>
+#include <set>
 
 namespace openpower
 {
@@ -23,6 +28,18 @@ namespace file_error = sdbusplus::xyz::openbmc_project::Common::File::Error;
 
 constexpr size_t warningPercentage = 95;
 
+// The transmission states are the last two bytes of the User Header, which
+// directly follows the Private Header.
+constexpr size_t hmcTransStateOffset =
+    PrivateHeader::flattenedSize() + UserHeader::flattenedSize() - 2;
+constexpr size_t hostTransStateOffset =
+    PrivateHeader::flattenedSize() + UserHeader::flattenedSize() - 1;
+
+// The file that PELs are written to before being renamed into place, when
+// they can't be written to an unnamed O_TMPFILE file.  Since PEL names
+// contain an '_', this can't be mistaken for a PEL.
+constexpr auto tempPELName = ".pel.tmp";
+
 /**
  * @brief Returns the amount of space the file uses on disk.
  *
@@ -48,10 +65,292 @@ size_t getFileDiskSize(const std::filesystem::path& file)
     return statData.st_blocks * statBlockSize;
 }
 
+/**
+ * @brief Reads a file into the buffer passed in with a single read,
+ *        reusing the buffer's memory.
+ *
+ * @param[in] file - The file to read
+ * @param[out] data - Filled in with the file contents
+ *
+ * @return bool - false if the file couldn't be opened or read, with
+ *                errno set.
+ */
+bool readFile(const std::filesystem::path& file, std::vector<uint8_t>& data)
+{
+    int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat statData;
+    if (fstat(fd, &statData) != 0)
+    {
+        auto e = errno;
+        close(fd);
+        errno = e;
+        return false;
+    }
+
+    data.resize(statData.st_size);
+
+    size_t offset = 0;
+    while (offset < data.size())
+    {
+        auto rc = pread(fd, data.data() + offset, data.size() - offset, offset);
+        if (rc < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            auto e = errno;
+            close(fd);
+            errno = e;
+            return false;
+        }
+
+        if (rc == 0)
+        {
+            break;
+        }
+
+        offset += rc;
+    }
+
+    close(fd);
+    data.resize(offset);
+
+    return true;
+}
+
+namespace
+{
+
+/**
+ * @brief Says if a section ID found after the User Header is sane.
+ *
+ * Section IDs are two uppercase letters, and the Private and User
+ * Headers can only be the first two sections.
+ *
+ * @param[in] id - The section ID
+ *
+ * @return bool - If the ID is sane
+ */
+bool validSectionID(uint16_t id)
+{
+    auto isUpper = [](uint8_t c) { return (c >= 'A') && (c <= 'Z'); };
+
+    return isUpper(id >> 8) && isUpper(id & 0xFF) &&
+           (id != static_cast<uint16_t>(SectionID::privateHeader)) &&
+           (id != static_cast<uint16_t>(SectionID::userHeader));
+}
+
+/**
+ * @brief The parts of a PEL needed to fill in its PELAttributes.
+ *
+ * Only the Private Header, User Header, and primary SRC sections are
+ * unflattened, instead of every section like the PEL class does.  The
+ * headers of the other sections are still checked, so a PEL that the
+ * PEL class couldn't unflatten isn't restored.
+ */
+struct PELHeaders
+{
+    std::unique_ptr<PrivateHeader> ph;
+    std::unique_ptr<UserHeader> uh;
+    std::unique_ptr<SRC> src;
+
+    /**
+     * @brief If the section headers after the User Header have sane
+     *        IDs and sizes that add up to the PEL size.
+     */
+    bool sectionsValid = false;
+
+    /**
+     * @brief Constructor
+     *
+     * @param[in] data - The PEL data
+     */
+    explicit PELHeaders(std::vector<uint8_t>& data)
+    {
+        Stream stream{data};
+        ph = std::make_unique<PrivateHeader>(stream);
+        uh = std::make_unique<UserHeader>(stream);
+
+        for (size_t i = 2; i < ph->sectionCount(); i++)
+        {
+            if (stream.remaining() < SectionHeader::flattenedSize())
+            {
+                return;
+            }
+
+            auto start = stream.offset();
+            SectionHeader header;
+            stream >> header;
+
+            if (!validSectionID(header.id) ||
+                (header.size < SectionHeader::flattenedSize()) ||
+                (header.size > data.size() - start))
+            {
+                return;
+            }
+
+            if (!src &&
+                (header.id == static_cast<uint16_t>(SectionID::primarySRC)))
+            {
+                stream.offset(start);
+                src = std::make_unique<SRC>(stream);
+            }
+
+            stream.offset(start + header.size);
+        }
+
+        sectionsValid = (stream.offset() == data.size());
+    }
+
+    /**
+     * @brief Says if the headers are valid, which also requires a valid
+     *        primary SRC for BMC and Hostboot PELs since it holds the
+     *        deconfig and guard flags, and intact section headers.
+     *
+     * @return bool - If valid
+     */
+    bool valid() const
+    {
+        if (!ph->valid() || !uh->valid() || !sectionsValid)
+        {
+            return false;
+        }
+
+        if (hasSRCFlags())
+        {
+            return src && src->valid();
+        }
+
+        return !src || src->valid();
+    }
+
+    /**
+     * @brief Says if the deconfig and guard flags come from the SRC,
+     *        which is the same as PEL::getDeconfigFlag() checks.
+     *
+     * @return bool - If the SRC flags are used
+     */
+    bool hasSRCFlags() const
+    {
+        auto creator = static_cast<CreatorID>(ph->creatorID());
+        return (creator == CreatorID::openBMC) ||
+               (creator == CreatorID::hostboot);
+    }
+
+    /**
+     * @brief Returns the PELAttributes for the PEL.
+     *
+     * @param[in] path - The PEL file path
+     * @param[in] sizeOnDisk - The space the PEL uses on disk
+     *
+     * @return PELAttributes - The attributes
+     */
+    Repository::PELAttributes getAttributes(const std::filesystem::path& path,
+                                            size_t sizeOnDisk) const
+    {
+        bool deconfig = false;
+        bool guard = false;
+
+        if (hasSRCFlags())
+        {
+            deconfig =
+                src->getErrorStatusFlag(SRC::ErrorStatusFlags::deconfigured);
+            guard = src->getErrorStatusFlag(SRC::ErrorStatusFlags::guarded);
+        }
+
+        return Repository::PELAttributes{
+            path,
+            sizeOnDisk,
+            ph->creatorID(),
+            uh->subsystem(),
+            uh->severity(),
+            uh->actionFlags(),
+            static_cast<TransmissionState>(uh->hostTransmissionState()),
+            static_cast<TransmissionState>(uh->hmcTransmissionState()),
+            ph->plid(),
+            deconfig,
+            guard,
+            getMillisecondsSinceEpoch(ph->createTimestamp())};
+    }
+};
+
+/**
+ * @brief The index file format identifier, 'PIDX', and version.
+ */
+constexpr uint32_t indexMagic = 0x50494458;
+constexpr uint8_t indexVersion = 1;
+
+/**
+ * @brief The PEL index file record types.
+ *
+ * A set record holds all of a PEL's attributes and replaces any
+ * earlier record for that PEL, and a remove record just has the PEL ID.
+ */
+enum class IndexRecordType : uint8_t
+{
+    set = 1,
+    remove = 2
+};
+
+/**
+ * @brief Builds a PEL index file record, which is a type, payload size,
+ *        payload, and a CRC of all of those.
+ *
+ * @param[in] id - The PEL's LogID
+ * @param[in] attributes - The PEL's attributes for a set record, or
+ *                         nullptr for a remove record.
+ *
+ * @return std::vector<uint8_t> - The record
+ */
+std::vector<uint8_t> makeIndexRecord(
+    const Repository::LogID& id, const Repository::PELAttributes* attributes)
+{
+    std::vector<uint8_t> payload;
+    Stream p{payload};
+    p << id.pelID.id;
+
+    if (attributes != nullptr)
+    {
+        auto name = attributes->path.filename().string();
+        p << id.obmcID.id << static_cast<uint16_t>(name.size())
+          << std::vector<char>{name.begin(), name.end()}
+          << static_cast<uint64_t>(attributes->sizeOnDisk)
+          << attributes->creator << attributes->subsystem
+          << attributes->severity
+          << static_cast<uint16_t>(attributes->actionFlags.to_ulong())
+          << static_cast<uint8_t>(attributes->hostState)
+          << static_cast<uint8_t>(attributes->hmcState) << attributes->plid
+          << static_cast<uint8_t>(attributes->deconfig)
+          << static_cast<uint8_t>(attributes->guard)
+          << attributes->creationTime;
+    }
+
+    auto type = (attributes != nullptr) ? IndexRecordType::set
+                                        : IndexRecordType::remove;
+
+    std::vector<uint8_t> record;
+    Stream r{record};
+    r << static_cast<uint8_t>(type) << static_cast<uint16_t>(payload.size())
+      << payload;
+    r << crc32(record.data(), record.size());
+
+    return record;
+}
+
+} // namespace
+
 Repository::Repository(const std::filesystem::path& basePath, size_t repoSize,
-                       size_t maxNumPELs) :
+                       size_t maxNumPELs, Storage storage) :
     _logPath(basePath / "logs"), _maxRepoSize(repoSize),
-    _maxNumPELs(maxNumPELs), _archivePath(basePath / "logs" / "archive")
+    _maxNumPELs(maxNumPELs), _archivePath(basePath / "logs" / "archive"),
+    _indexPath(basePath / "index")
 {
     if (!fs::exists(_logPath))
     {
@@ -63,11 +362,72 @@ Repository::Repository(const std::filesystem::path& basePath, size_t repoSize,
         fs::create_directories(_archivePath);
     }
 
+    if (storage == Storage::segments)
+    {
+        // Compact the segments before the space that removed PELs
+        // still take up in them puts the PELs over the size limit.
+        _segments = std::make_unique<SegmentStore>(
+            _logPath / "segments", SegmentStore::defaultSegmentSize,
+            _maxRepoSize);
+    }
+
     restore();
 }
 
 void Repository::restore()
 {
+    // Remove any temporary file left from a write that didn't finish.
+    std::error_code ec;
+    fs::remove(_logPath / tempPELName, ec);
+    fs::remove(_archivePath / tempPELName, ec);
+
+    if (_segments)
+    {
+        // Reading the segments is as fast as reading the index, so
+        // there isn't one.
+        fs::remove(_indexPath, ec);
+        importPELFiles();
+        restoreFromSegments();
+    }
+    else if (restoreFromIndex())
+    {
+        // If the host hasn't acked a PEL, reset the host state so
+        // it will get sent up again.
+        std::vector<uint32_t> sentPELs;
+        for (const auto& [id, attributes] : _pelAttributes)
+        {
+            if (attributes.hostState == TransmissionState::sent)
+            {
+                sentPELs.push_back(id.pelID.id);
+            }
+        }
+
+        for (auto id : sentPELs)
+        {
+            setPELHostTransState(id, TransmissionState::newPEL);
+        }
+    }
+    else
+    {
+        restoreFromFiles();
+    }
+
+    // Start a fresh index with what was just restored.
+    writeIndex();
+
+    // Get size of archive folder
+    for (auto& dirEntry : fs::directory_iterator(_archivePath))
+    {
+        _archiveSize += getFileDiskSize(dirEntry);
+    }
+}
+
+void Repository::restoreFromFiles()
+{
+    // Reused for every file.  Only the headers needed for the attributes
+    // are unflattened, not the whole PEL.
+    std::vector<uint8_t> data;
+
     for (auto& dirEntry : fs::directory_iterator(_logPath))
     {
         try
@@ -77,51 +437,53 @@ void Repository::restore()
                 continue;
             }
 
-            std::ifstream file{dirEntry.path()};
-            std::vector<uint8_t> data{std::istreambuf_iterator<char>(file),
-                                      std::istreambuf_iterator<char>()};
-            file.close();
+            if (!readFile(dirEntry.path(), data))
+            {
+                auto e = errno;
+                lg2::error("Unable to read PEL file {FILE}, errno = {ERRNO}",
+                           "FILE", dirEntry.path(), "ERRNO", e);
+                continue;
+            }
 
-            PEL pel{data};
-            if (pel.valid())
+            PELHeaders headers{data};
+            if (headers.valid())
             {
                 // If the host hasn't acked it, reset the host state so
                 // it will get sent up again.
-                if (pel.hostTransmissionState() == TransmissionState::sent)
+                if (static_cast<TransmissionState>(
+                        headers.uh->hostTransmissionState()) ==
+                    TransmissionState::sent)
                 {
-                    pel.setHostTransmissionState(TransmissionState::newPEL);
-                    try
-                    {
-                        write(pel, dirEntry.path());
-                    }
-                    catch (const std::exception& e)
+                    std::array<uint8_t, 1> value{
+                        static_cast<uint8_t>(TransmissionState::newPEL)};
+                    headers.uh->setHostTransmissionState(value[0]);
+
+                    if (!patchPEL(dirEntry.path(), headers.ph->id(),
+                                  hostTransStateOffset, value))
                     {
-                        lg2::error(
-                            "Failed to save PEL after updating host state, PEL ID = {ID}",
-                            "ID", lg2::hex, pel.id());
+                        PEL pel{data};
+                        pel.setHostTransmissionState(TransmissionState::newPEL);
+                        try
+                        {
+                            write(pel, dirEntry.path());
+                        }
+                        catch (const std::exception& e)
+                        {
+                            lg2::error(
+                                "Failed to save PEL after updating host state, PEL ID = {ID}",
+                                "ID", lg2::hex, pel.id());
+                        }
                     }
                 }
 
-                PELAttributes attributes{
-                    dirEntry.path(),
-                    getFileDiskSize(dirEntry.path()),
-                    pel.privateHeader().creatorID(),
-                    pel.userHeader().subsystem(),
-                    pel.userHeader().severity(),
-                    pel.userHeader().actionFlags(),
-                    pel.hostTransmissionState(),
-                    pel.hmcTransmissionState(),
-                    pel.plid(),
-                    pel.getDeconfigFlag(),
-                    pel.getGuardFlag(),
-                    getMillisecondsSinceEpoch(
-                        pel.privateHeader().createTimestamp())};
+                auto attributes = headers.getAttributes(
+                    dirEntry.path(), getFileDiskSize(dirEntry.path()));
 
                 using pelID = LogID::Pel;
                 using obmcID = LogID::Obmc;
-                _pelAttributes.emplace(
-                    LogID(pelID(pel.id()), obmcID(pel.obmcLogID())),
-                    attributes);
+                addPELAttributes(LogID(pelID(headers.ph->id()),
+                                       obmcID(headers.ph->obmcLogID())),
+                                 attributes);
 
                 updateRepoStats(attributes, true);
             }
@@ -139,12 +501,391 @@ void Repository::restore()
                        "FILE", dirEntry.path(), "ERROR", e);
         }
     }
+}
+
+void Repository::importPELFiles()
+{
+    // Import them oldest first, which is the order of their names.
+    std::vector<fs::path> files;
+    for (const auto& dirEntry : fs::directory_iterator(_logPath))
+    {
+        if (dirEntry.is_regular_file() &&
+            (dirEntry.path().filename() != tempPELName))
+        {
+            files.push_back(dirEntry.path());
+        }
+    }
+
+    if (files.empty())
+    {
+        return;
+    }
+
+    std::ranges::sort(files);
+
+    std::vector<uint8_t> data;
+    size_t imported = 0;
+
+    for (const auto& file : files)
+    {
+        try
+        {
+            if (!readFile(file, data))
+            {
+                auto e = errno;
+                lg2::error("Unable to read PEL file {FILE}, errno = {ERRNO}",
+                           "FILE", file, "ERRNO", e);
+                continue;
+            }
+
+            PELHeaders headers{data};
+            if (!headers.valid())
+            {
+                lg2::error(
+                    "Found invalid PEL file {FILE} while importing.  Removing.",
+                    "FILE", file);
+                fs::remove(file);
+                continue;
+            }
+
+            // The file is only removed once its PEL is safely stored.
+            if (!_segments->contains(headers.ph->id()))
+            {
+                _segments->add(headers.ph->id(), data, true);
+            }
+
+            fs::remove(file);
+            imported++;
+        }
+        catch (const std::exception& e)
+        {
+            lg2::error("Unable to import PEL file {FILE}: {ERROR}", "FILE",
+                       file, "ERROR", e);
+        }
+    }
+
+    lg2::info("Imported {IMPORTED} of {TOTAL} PEL files into the PEL segments",
+              "IMPORTED", imported, "TOTAL", files.size());
+}
+
+void Repository::restoreFromSegments()
+{
+    // Reused for every PEL.
+    std::vector<uint8_t> data;
+
+    for (auto id : _segments->ids())
+    {
+        try
+        {
+            if (!_segments->read(id, data))
+            {
+                auto e = errno;
+                lg2::error("Unable to read PEL {ID}, errno = {ERRNO}", "ID",
+                           lg2::hex, id, "ERRNO", e);
+                continue;
+            }
+
+            PELHeaders headers{data};
+            if (!headers.valid() || (headers.ph->id() != id))
+            {
+                lg2::error("Found invalid PEL {ID} while restoring.  Removing.",
+                           "ID", lg2::hex, id);
+                _segments->remove(id);
+                continue;
+            }
+
+            // If the host hasn't acked it, reset the host state so
+            // it will get sent up again.
+            if (static_cast<TransmissionState>(
+                    headers.uh->hostTransmissionState()) ==
+                TransmissionState::sent)
+            {
+                std::array<uint8_t, 1> value{
+                    static_cast<uint8_t>(TransmissionState::newPEL)};
+                headers.uh->setHostTransmissionState(value[0]);
+                _segments->patch(id, hostTransStateOffset, value);
+            }
+
+            auto path =
+                _logPath / getPELFilename(id, headers.ph->commitTimestamp());
+            auto attributes =
+                headers.getAttributes(path, _segments->diskSize(id));
+
+            using pelID = LogID::Pel;
+            using obmcID = LogID::Obmc;
+            addPELAttributes(LogID(pelID(id), obmcID(headers.ph->obmcLogID())),
+                             attributes);
+
+            updateRepoStats(attributes, true);
+        }
+        catch (const std::exception& e)
+        {
+            lg2::error("Hit exception while restoring PEL {ID}: {ERROR}", "ID",
+                       lg2::hex, id, "ERROR", e);
+        }
+    }
+}
+
+bool Repository::restoreFromIndex()
+{
+    std::vector<uint8_t> data;
+    if (!readFile(_indexPath, data))
+    {
+        return false;
+    }
+
+    std::map<uint32_t, std::pair<LogID, PELAttributes>> pels;
+
+    try
+    {
+        Stream stream{data};
+        uint32_t magic = 0;
+        uint8_t version = 0;
+        stream >> magic >> version;
+
+        if ((magic != indexMagic) || (version != indexVersion))
+        {
+            lg2::info("PEL index file has an unknown format");
+            return false;
+        }
+
+        while (stream.remaining() > 0)
+        {
+            auto start = stream.offset();
+            uint8_t type = 0;
+            uint16_t size = 0;
+            stream >> type >> size;
+
+            std::vector<uint8_t> payload(size);
+            stream >> payload;
+
+            uint32_t crc = 0;
+            stream >> crc;
+
+            if (crc != crc32(data.data() + start, stream.offset() - start - 4))
+            {
+                lg2::info("PEL index file has a bad checksum");
+                return false;
+            }
+
+            Stream record{payload};
+            uint32_t pelID = 0;
+            record >> pelID;
+
+            if (type == static_cast<uint8_t>(IndexRecordType::remove))
+            {
+                pels.erase(pelID);
+                continue;
+            }
+
+            if (type != static_cast<uint8_t>(IndexRecordType::set))
+            {
+                lg2::info("PEL index file has an unknown record type {TYPE}",
+                          "TYPE", type);
+                return false;
+            }
+
+            uint32_t obmcID = 0;
+            uint16_t nameSize = 0;
+            record >> obmcID >> nameSize;
+
+            std::vector<char> name(nameSize);
+            record >> name;
+
+            uint64_t sizeOnDisk = 0;
+            uint8_t creator = 0;
+            uint8_t subsystem = 0;
+            uint8_t severity = 0;
+            uint16_t actionFlags = 0;
+            uint8_t hostState = 0;
+            uint8_t hmcState = 0;
+            uint32_t plid = 0;
+            uint8_t deconfig = 0;
+            uint8_t guard = 0;
+            uint64_t creationTime = 0;
+
+            record >> sizeOnDisk >> creator >> subsystem >> severity >>
+                actionFlags >> hostState >> hmcState >> plid >> deconfig >>
+                guard >> creationTime;
+
+            pels.insert_or_assign(
+                pelID,
+                std::make_pair(
+                    LogID{LogID::Pel{pelID}, LogID::Obmc{obmcID}},
+                    PELAttributes{_logPath / std::string{name.begin(),
+                                                         name.end()},
+                                  sizeOnDisk, creator, subsystem, severity,
+                                  actionFlags,
+                                  static_cast<TransmissionState>(hostState),
+                                  static_cast<TransmissionState>(hmcState),
+                                  plid, deconfig != 0, guard != 0,
+                                  creationTime}));
+        }
+    }
+    catch (const std::exception& e)
+    {
+        lg2::info("PEL index file is truncated: {ERROR}", "ERROR", e);
+        return false;
+    }
+
+    // The index can only be used if it has the same PELs as the directory.
+    std::set<fs::path> files;
+    for (const auto& dirEntry : fs::directory_iterator(_logPath))
+    {
+        if (dirEntry.is_regular_file())
+        {
+            files.insert(dirEntry.path());
+        }
+    }
+
+    if ((files.size() != pels.size()) ||
+        !std::ranges::all_of(pels, [&files](const auto& pel) {
+            return files.contains(pel.second.second.path);
+        }))
+    {
+        lg2::info("PEL index doesn't match the PEL files, restoring from "
+                  "the files instead");
+        return false;
+    }
+
+    for (const auto& [pelID, pel] : pels)
+    {
+        addPELAttributes(pel.first, pel.second);
+        updateRepoStats(pel.second, true);
+    }
+
+    return true;
+}
+
+void Repository::writeIndex()
+{
+    if (_segments)
+    {
+        return;
+    }
+
+    std::vector<uint8_t> data;
+    Stream stream{data};
+    stream << indexMagic << indexVersion;
+
+    for (const auto& [id, attributes] : _pelAttributes)
+    {
+        stream << makeIndexRecord(id, &attributes);
+    }
+
+    auto tempPath = _indexPath;
+    tempPath += ".tmp";
+
+    std::ofstream file{tempPath, std::ios::binary};
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    file.close();
+
+    std::error_code ec;
+    if (file.fail())
+    {
+        lg2::error("Unable to write PEL index file {FILE}", "FILE", tempPath);
+        fs::remove(tempPath, ec);
+        fs::remove(_indexPath, ec);
+        return;
+    }
+
+    fs::rename(tempPath, _indexPath, ec);
+    if (ec)
+    {
+        lg2::error("Unable to rename PEL index file {FILE}: {ERROR}", "FILE",
+                   tempPath, "ERROR", ec.message());
+        fs::remove(tempPath, ec);
+        fs::remove(_indexPath, ec);
+        return;
+    }
+
+    _indexRecords = 0;
+}
+
+void Repository::updateIndex(const LogID& id, const PELAttributes* attributes)
+{
+    if (_segments)
+    {
+        return;
+    }
+
+    // If there isn't an index, the next restore will use the PEL files.
+    int fd = open(_indexPath.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return;
+    }
+
+    auto record = makeIndexRecord(id, attributes);
+    auto rc = ::write(fd, record.data(), record.size());
+    auto e = errno;
+    close(fd);
+
+    if (rc != static_cast<ssize_t>(record.size()))
+    {
+        // Remove the index so that it isn't used with stale contents.
+        lg2::error("Unable to update PEL index file {FILE}, errno = {ERRNO}",
+                   "FILE", _indexPath, "ERRNO", e);
+        std::error_code ec;
+        fs::remove(_indexPath, ec);
+        return;
+    }
 
-    // Get size of archive folder
-    for (auto& dirEntry : fs::directory_iterator(_archivePath))
+    // Keep the file from growing without bound by compacting it
+    // once there are a lot more records than PELs.
+    if (++_indexRecords > std::max(_maxNumPELs, _pelAttributes.size()) * 4)
     {
-        _archiveSize += getFileDiskSize(dirEntry);
+        writeIndex();
+    }
+}
+
+bool Repository::addPELAttributes(const LogID& id,
+                                  const PELAttributes& attributes)
+{
+    auto [it, added] = _pelAttributes.emplace(id, attributes);
+    if (!added)
+    {
+        return false;
+    }
+
+    if (id.obmcID.id != 0)
+    {
+        auto next = _obmcIDIndex.lower_bound({id.obmcID.id, 0});
+        if ((next != _obmcIDIndex.end()) && (next->first == id.obmcID.id))
+        {
+            lg2::info("PEL {PEL_ID} has the same OpenBMC log ID {BMC_ID} "
+                      "as PEL {OTHER_ID}",
+                      "PEL_ID", lg2::hex, id.pelID.id, "BMC_ID",
+                      id.obmcID.id, "OTHER_ID", lg2::hex, next->second);
+        }
+
+        _obmcIDIndex.emplace(id.obmcID.id, id.pelID.id);
     }
+
+    addToEvictionOrder(it);
+
+    return true;
+}
+
+void Repository::erasePELAttributes(
+    std::map<LogID, PELAttributes>::const_iterator it)
+{
+    _obmcIDIndex.erase({it->first.obmcID.id, it->first.pelID.id});
+
+    removeFromEvictionOrder(it);
+    _pelAttributes.erase(it);
+}
+
+void Repository::addToEvictionOrder(AttributesIterator it)
+{
+    _evictionOrder[pruneCategory(it->second)][prunePass(it->second)].insert(
+        it);
+}
+
+void Repository::removeFromEvictionOrder(AttributesIterator it)
+{
+    _evictionOrder[pruneCategory(it->second)][prunePass(it->second)].erase(
+        it);
 }
 
 std::string Repository::getPELFilename(uint32_t pelID, const BCDTime& time)
@@ -163,11 +904,11 @@ void Repository::add(std::unique_ptr<PEL>& pel)
 
     auto path = _logPath / getPELFilename(pel->id(), pel->commitTime());
 
-    write(*(pel.get()), path);
+    write(*(pel.get()), path, !_groupCommit);
 
     PELAttributes attributes{
         path,
-        getFileDiskSize(path),
+        _segments ? _segments->diskSize(pel->id()) : getFileDiskSize(path),
         pel->privateHeader().creatorID(),
         pel->userHeader().subsystem(),
         pel->userHeader().severity(),
@@ -181,8 +922,9 @@ void Repository::add(std::unique_ptr<PEL>& pel)
 
     using pelID = LogID::Pel;
     using obmcID = LogID::Obmc;
-    _pelAttributes.emplace(LogID(pelID(pel->id()), obmcID(pel->obmcLogID())),
-                           attributes);
+    LogID id{pelID(pel->id()), obmcID(pel->obmcLogID())};
+    addPELAttributes(id, attributes);
+    updateIndex(id, &attributes);
 
     _lastPelID = pel->id();
 
@@ -191,16 +933,73 @@ void Repository::add(std::unique_ptr<PEL>& pel)
     processAddCallbacks(*pel);
 }
 
-void Repository::write(const PEL& pel, const fs::path& path)
+void Repository::write(const PEL& pel, const fs::path& path, bool sync)
+{
+    if (!_segments)
+    {
+        writeFile(pel, path, sync);
+        return;
+    }
+
+    _segments->add(pel.id(), pel.data(), sync);
+    if (!sync)
+    {
+        _syncPending = true;
+    }
+}
+
+bool Repository::readPEL(const fs::path& path, std::vector<uint8_t>& data) const
+{
+    if (!_segments)
+    {
+        return readFile(path, data);
+    }
+
+    // The PEL ID is at the end of the name made by getPELFilename().
+    auto name = path.filename().string();
+    auto pos = name.find_last_of('_');
+    if (pos == std::string::npos)
+    {
+        errno = ENOENT;
+        return false;
+    }
+
+    uint32_t pelID = 0;
+    try
+    {
+        pelID = std::stoul(name.substr(pos + 1), nullptr, 16);
+    }
+    catch (const std::exception&)
+    {
+        errno = ENOENT;
+        return false;
+    }
+
+    return _segments->read(pelID, data);
+}
+
+void Repository::writeFile(const PEL& pel, const fs::path& path, bool sync)
 {
-    std::ofstream file{path, std::ios::binary};
+    auto dir = path.parent_path();
+    auto tempPath = dir / tempPELName;
+
+    // Write to an unnamed file in the directory that is only given a
+    // name once it's complete.  If the filesystem doesn't support that,
+    // use a temporary file that is renamed.
+    bool unnamed = true;
+    int fd = open(dir.c_str(), O_TMPFILE | O_WRONLY | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        unnamed = false;
+        fd = open(tempPath.c_str(), O_CREAT | O_TRUNC | O_WRONLY | O_CLOEXEC,
+                  0644);
+    }
 
-    if (!file.good())
+    if (fd < 0)
     {
         // If this fails, the filesystem is probably full so it isn't like
         // we could successfully create yet another error log here.
         auto e = errno;
-        fs::remove(path);
         lg2::error(
             "Unable to open PEL file {FILE} for writing, errno = {ERRNO}",
             "FILE", path, "ERRNO", e);
@@ -208,22 +1007,164 @@ void Repository::write(const PEL& pel, const fs::path& path)
     }
 
     auto data = pel.data();
-    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    size_t offset = 0;
+    int e = 0;
 
-    if (file.fail())
+    while (offset < data.size())
+    {
+        auto rc = ::write(fd, data.data() + offset, data.size() - offset);
+        if (rc < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            e = errno;
+            break;
+        }
+        offset += rc;
+    }
+
+    if ((e == 0) && sync && (fsync(fd) != 0))
+    {
+        e = errno;
+    }
+
+    bool linked = false;
+    if ((e == 0) && unnamed)
+    {
+        // linkat() won't replace an existing file, so when rewriting a
+        // PEL link it to the temporary name and rename it from there.
+        auto fdPath = "/proc/self/fd/" + std::to_string(fd);
+        if (linkat(AT_FDCWD, fdPath.c_str(), AT_FDCWD, path.c_str(),
+                   AT_SYMLINK_FOLLOW) == 0)
+        {
+            linked = true;
+        }
+        else if (errno == EEXIST)
+        {
+            unlink(tempPath.c_str());
+            if (linkat(AT_FDCWD, fdPath.c_str(), AT_FDCWD, tempPath.c_str(),
+                       AT_SYMLINK_FOLLOW) != 0)
+            {
+                e = errno;
+            }
+        }
+        else
+        {
+            e = errno;
+        }
+    }
+
+    close(fd);
+
+    if ((e == 0) && !linked && (rename(tempPath.c_str(), path.c_str()) != 0))
+    {
+        e = errno;
+    }
+
+    if (e != 0)
     {
         // Same note as above about not being able to create an error log
-        // for this case even if we wanted.
-        auto e = errno;
-        file.close();
-        fs::remove(path);
+        // for this case even if we wanted.  Any previous contents of the
+        // file are still intact.
+        unlink(tempPath.c_str());
         lg2::error("Unable to write PEL file {FILE}, errno = {ERRNO}", "FILE",
                    path, "ERRNO", e);
         throw file_error::Write();
     }
+
+    if (!sync)
+    {
+        _syncPending = true;
+        return;
+    }
+
+    // Sync the directory entry too.  The PEL data is already safe, so
+    // just log a failure.
+    int dirFD = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if ((dirFD < 0) || (fsync(dirFD) != 0))
+    {
+        e = errno;
+        lg2::error("Unable to sync PEL directory {DIR}, errno = {ERRNO}",
+                   "DIR", dir, "ERRNO", e);
+    }
+
+    if (dirFD >= 0)
+    {
+        close(dirFD);
+    }
+}
+
+void Repository::sync()
+{
+    if (!_syncPending)
+    {
+        return;
+    }
+
+    _syncPending = false;
+
+    // The new PELs could be in either the logs or archive directory, which
+    // are on the same filesystem, so sync the filesystem once instead of
+    // syncing each file and directory.
+    int fd = open(_logPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if ((fd < 0) || (syncfs(fd) != 0))
+    {
+        auto e = errno;
+        lg2::error("Unable to sync PEL repository {DIR}, errno = {ERRNO}",
+                   "DIR", _logPath, "ERRNO", e);
+    }
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
 }
 
 std::optional<Repository::LogID> Repository::remove(const LogID& id)
+{
+    auto actualID = removePEL(id);
+    if (actualID)
+    {
+        updateIndex(*actualID, nullptr);
+    }
+
+    return actualID;
+}
+
+std::vector<Repository::LogID> Repository::remove(const std::vector<LogID>& ids)
+{
+    std::vector<LogID> removed;
+    removed.reserve(ids.size());
+
+    for (const auto& id : ids)
+    {
+        auto actualID = removePEL(id);
+        if (actualID)
+        {
+            removed.push_back(*actualID);
+        }
+    }
+
+    // Append a record per PEL, unless rewriting the index with what's
+    // left, such as after deleting everything, is smaller.
+    if (removed.size() >= std::max<size_t>(_pelAttributes.size(), 1))
+    {
+        writeIndex();
+    }
+    else
+    {
+        for (const auto& id : removed)
+        {
+            updateIndex(id, nullptr);
+        }
+    }
+
+    return removed;
+}
+
+std::optional<Repository::LogID> Repository::removePEL(const LogID& id)
 {
     auto pel = findPEL(id);
     if (pel == _pelAttributes.end())
@@ -238,7 +1179,11 @@ std::optional<Repository::LogID> Repository::remove(const LogID& id)
         "Removing PEL from repository, PEL ID = {PEL_ID}, BMC log ID = {BMC_ID}",
         "PEL_ID", lg2::hex, actualID.pelID.id, "BMC_ID", actualID.obmcID.id);
 
-    if (fs::exists(pel->second.path))
+    if (_segments)
+    {
+        _segments->remove(actualID.pelID.id);
+    }
+    else if (fs::exists(pel->second.path))
     {
         // Check for existence of new archive folder
         if (!fs::exists(_archivePath))
@@ -254,7 +1199,7 @@ std::optional<Repository::LogID> Repository::remove(const LogID& id)
         _archiveSize += getFileDiskSize(fileName);
     }
 
-    _pelAttributes.erase(pel);
+    erasePELAttributes(pel);
 
     processDeleteCallbacks(actualID.pelID.id);
 
@@ -266,8 +1211,8 @@ std::optional<std::vector<uint8_t>> Repository::getPELData(const LogID& id)
     auto pel = findPEL(id);
     if (pel != _pelAttributes.end())
     {
-        std::ifstream file{pel->second.path.c_str()};
-        if (!file.good())
+        std::vector<uint8_t> data;
+        if (!readPEL(pel->second.path, data))
         {
             auto e = errno;
             lg2::error("Unable to open PEL file {FILE}, errno = {ERRNO}",
@@ -275,8 +1220,6 @@ std::optional<std::vector<uint8_t>> Repository::getPELData(const LogID& id)
             throw file_error::Open();
         }
 
-        std::vector<uint8_t> data{std::istreambuf_iterator<char>(file),
-                                  std::istreambuf_iterator<char>()};
         return data;
     }
 
@@ -288,7 +1231,10 @@ std::optional<sdbusplus::message::unix_fd> Repository::getPELFD(const LogID& id)
     auto pel = findPEL(id);
     if (pel != _pelAttributes.end())
     {
-        int fd = open(pel->second.path.c_str(), O_RDONLY | O_NONBLOCK);
+        // A PEL in the segments is passed in its own sealed memfd.
+        int fd = _segments
+                     ? _segments->getFD(pel->first.pelID.id)
+                     : open(pel->second.path.c_str(), O_RDONLY | O_NONBLOCK);
         if (fd == -1)
         {
             auto e = errno;
@@ -306,11 +1252,11 @@ std::optional<sdbusplus::message::unix_fd> Repository::getPELFD(const LogID& id)
 
 void Repository::for_each(ForEachFunc func) const
 {
+    std::vector<uint8_t> data;
+
     for (const auto& [id, attributes] : _pelAttributes)
     {
-        std::ifstream file{attributes.path};
-
-        if (!file.good())
+        if (!readPEL(attributes.path, data))
         {
             auto e = errno;
             lg2::error(
@@ -319,10 +1265,6 @@ void Repository::for_each(ForEachFunc func) const
             continue;
         }
 
-        std::vector<uint8_t> data{std::istreambuf_iterator<char>(file),
-                                  std::istreambuf_iterator<char>()};
-        file.close();
-
         PEL pel{data};
 
         try
@@ -388,19 +1330,28 @@ std::optional<std::reference_wrapper<const Repository::PELAttributes>>
 
 void Repository::setPELHostTransState(uint32_t pelID, TransmissionState state)
 {
-    LogID id{LogID::Pel{pelID}};
-    auto attr = std::find_if(_pelAttributes.begin(), _pelAttributes.end(),
-                             [&id](const auto& a) { return a.first == id; });
+    auto attr = _pelAttributes.find(LogID{LogID::Pel{pelID}});
 
     if ((attr != _pelAttributes.end()) && (attr->second.hostState != state))
     {
-        PELUpdateFunc func = [state](PEL& pel) {
-            pel.setHostTransmissionState(state);
-            return true;
-        };
-
         try
         {
+            std::array<uint8_t, 1> value{static_cast<uint8_t>(state)};
+            if (patchPEL(attr->second.path, pelID, hostTransStateOffset,
+                         value))
+            {
+                removeFromEvictionOrder(attr);
+                attr->second.hostState = state;
+                addToEvictionOrder(attr);
+                updateIndex(attr->first, &attr->second);
+                return;
+            }
+
+            PELUpdateFunc func = [state](PEL& pel) {
+                pel.setHostTransmissionState(state);
+                return true;
+            };
+
             updatePEL(attr->second.path, func);
         }
         catch (const std::exception& e)
@@ -414,19 +1365,27 @@ void Repository::setPELHostTransState(uint32_t pelID, TransmissionState state)
 
 void Repository::setPELHMCTransState(uint32_t pelID, TransmissionState state)
 {
-    LogID id{LogID::Pel{pelID}};
-    auto attr = std::find_if(_pelAttributes.begin(), _pelAttributes.end(),
-                             [&id](const auto& a) { return a.first == id; });
+    auto attr = _pelAttributes.find(LogID{LogID::Pel{pelID}});
 
     if ((attr != _pelAttributes.end()) && (attr->second.hmcState != state))
     {
-        PELUpdateFunc func = [state](PEL& pel) {
-            pel.setHMCTransmissionState(state);
-            return true;
-        };
-
         try
         {
+            std::array<uint8_t, 1> value{static_cast<uint8_t>(state)};
+            if (patchPEL(attr->second.path, pelID, hmcTransStateOffset, value))
+            {
+                removeFromEvictionOrder(attr);
+                attr->second.hmcState = state;
+                addToEvictionOrder(attr);
+                updateIndex(attr->first, &attr->second);
+                return;
+            }
+
+            PELUpdateFunc func = [state](PEL& pel) {
+                pel.setHMCTransmissionState(state);
+                return true;
+            };
+
             updatePEL(attr->second.path, func);
         }
         catch (const std::exception& e)
@@ -438,12 +1397,82 @@ void Repository::setPELHMCTransState(uint32_t pelID, TransmissionState state)
     }
 }
 
+bool Repository::patchPEL(const fs::path& path, uint32_t pelID, size_t offset,
+                          std::span<const uint8_t> bytes)
+{
+    constexpr size_t headersSize =
+        PrivateHeader::flattenedSize() + UserHeader::flattenedSize();
+
+    if (offset + bytes.size() > headersSize)
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> data(headersSize);
+    int fd = -1;
+
+    if (_segments)
+    {
+        if (!_segments->read(pelID, data) || (data.size() < headersSize))
+        {
+            return false;
+        }
+        data.resize(headersSize);
+    }
+    else
+    {
+        fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        auto rc = pread(fd, data.data(), data.size(), 0);
+        if (rc != static_cast<ssize_t>(data.size()))
+        {
+            close(fd);
+            return false;
+        }
+    }
+
+    Stream stream{data};
+    PrivateHeader ph{stream};
+    UserHeader uh{stream};
+
+    if (!ph.valid() || !uh.valid() || (ph.id() != pelID) ||
+        (ph.header().size != PrivateHeader::flattenedSize()) ||
+        (uh.header().size != UserHeader::flattenedSize()))
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return false;
+    }
+
+    if (_segments)
+    {
+        return _segments->patch(pelID, offset, bytes);
+    }
+
+    auto rc = pwrite(fd, bytes.data(), bytes.size(), offset);
+    close(fd);
+
+    if (rc != static_cast<ssize_t>(bytes.size()))
+    {
+        auto e = errno;
+        lg2::error("Unable to patch PEL file {FILE}, errno = {ERRNO}", "FILE",
+                   path, "ERRNO", e);
+        return false;
+    }
+
+    return true;
+}
+
 bool Repository::updatePEL(const fs::path& path, PELUpdateFunc updateFunc)
 {
-    std::ifstream file{path};
-    std::vector<uint8_t> data{std::istreambuf_iterator<char>(file),
-                              std::istreambuf_iterator<char>()};
-    file.close();
+    std::vector<uint8_t> data;
+    readPEL(path, data);
 
     PEL pel{data};
 
@@ -458,18 +1487,22 @@ bool Repository::updatePEL(const fs::path& path, PELUpdateFunc updateFunc)
             //  - deconfig flag - Can be cleared for PELs that call out
             //                    hotplugged FRUs.
             // Make sure they're up to date.
-            LogID id{LogID::Pel(pel.id())};
-            auto attr =
-                std::find_if(_pelAttributes.begin(), _pelAttributes.end(),
-                             [&id](const auto& a) { return a.first == id; });
+            auto attr = _pelAttributes.find(LogID{LogID::Pel(pel.id())});
             if (attr != _pelAttributes.end())
             {
+                removeFromEvictionOrder(attr);
                 attr->second.hmcState = pel.hmcTransmissionState();
                 attr->second.hostState = pel.hostTransmissionState();
+                addToEvictionOrder(attr);
                 attr->second.deconfig = pel.getDeconfigFlag();
             }
 
             write(pel, path);
+
+            if (attr != _pelAttributes.end())
+            {
+                updateIndex(attr->first, &attr->second);
+            }
             return true;
         }
     }
@@ -577,28 +1610,6 @@ bool Repository::sizeWarning()
            (_pelAttributes.size() > _maxNumPELs);
 }
 
-std::vector<Repository::AttributesReference> Repository::getAllPELAttributes(
-    SortOrder order) const
-{
-    std::vector<Repository::AttributesReference> attributes;
-
-    std::for_each(_pelAttributes.begin(), _pelAttributes.end(),
-                  [&attributes](auto& pelEntry) {
-                      attributes.push_back(pelEntry);
-                  });
-
-    std::sort(attributes.begin(), attributes.end(),
-              [order](const auto& left, const auto& right) {
-                  if (order == SortOrder::ascending)
-                  {
-                      return left.get().second.path < right.get().second.path;
-                  }
-                  return left.get().second.path > right.get().second.path;
-              });
-
-    return attributes;
-}
-
 std::vector<uint32_t> Repository::prune(
     const std::vector<uint32_t>& idsWithHwIsoEntry)
 {
@@ -635,51 +1646,29 @@ std::vector<uint32_t> Repository::prune(
         return _pelAttributes.size() > _maxNumPELs * 80 / 100;
     };
 
-    // Set up the functions to determine which category a PEL is in.
-    // TODO: Return false in these functions if a PEL caused a guard record.
-
-    // A BMC informational PEL
-    IsPELTypeFunc isBMCInfo = [](const PELAttributes& pel) {
-        return (CreatorID::openBMC == static_cast<CreatorID>(pel.creator)) &&
-               !Repository::isServiceableSev(pel);
-    };
-
-    // A BMC non informational PEL
-    IsPELTypeFunc isBMCNonInfo = [](const PELAttributes& pel) {
-        return (CreatorID::openBMC == static_cast<CreatorID>(pel.creator)) &&
-               Repository::isServiceableSev(pel);
-    };
-
-    // A non BMC informational PEL
-    IsPELTypeFunc isNonBMCInfo = [](const PELAttributes& pel) {
-        return (CreatorID::openBMC != static_cast<CreatorID>(pel.creator)) &&
-               !Repository::isServiceableSev(pel);
-    };
-
-    // A non BMC non informational PEL
-    IsPELTypeFunc isNonBMCNonInfo = [](const PELAttributes& pel) {
-        return (CreatorID::openBMC != static_cast<CreatorID>(pel.creator)) &&
-               Repository::isServiceableSev(pel);
-    };
-
-    // When counting PELs, count every PEL
-    IsPELTypeFunc isAnyPEL = [](const PELAttributes& /*pel*/) { return true; };
+    // PELs with a hardware isolation entry are never removed.
+    std::set<uint32_t> hwIsoIDs{idsWithHwIsoEntry.begin(),
+                                idsWithHwIsoEntry.end()};
 
     // Check all 4 categories, which will result in at most 90%
-    // usage (15 + 30 + 15 + 30).
-    removePELs(overBMCInfoLimit, isBMCInfo, idsWithHwIsoEntry, obmcLogIDs);
-    removePELs(overBMCNonInfoLimit, isBMCNonInfo, idsWithHwIsoEntry,
-               obmcLogIDs);
-    removePELs(overNonBMCInfoLimit, isNonBMCInfo, idsWithHwIsoEntry,
-               obmcLogIDs);
-    removePELs(overNonBMCNonInfoLimit, isNonBMCNonInfo, idsWithHwIsoEntry,
-               obmcLogIDs);
+    // usage (15 + 30 + 15 + 30).  These are in prune category order.
+    std::array<IsOverLimitFunc, numPruneCategories> categoryLimits{
+        overBMCInfoLimit, overBMCNonInfoLimit, overNonBMCInfoLimit,
+        overNonBMCNonInfoLimit};
+
+    std::array<size_t, numPruneCategories> allCategories{0, 1, 2, 3};
+    for (size_t category = 0; category < numPruneCategories; category++)
+    {
+        removePELs(categoryLimits[category],
+                   std::span{allCategories}.subspan(category, 1), hwIsoIDs,
+                   obmcLogIDs);
+    }
 
     // After the above pruning check if there are still too many PELs,
     // which can happen depending on PEL sizes.
     if (_pelAttributes.size() > _maxNumPELs)
     {
-        removePELs(tooManyPELsLimit, isAnyPEL, idsWithHwIsoEntry, obmcLogIDs);
+        removePELs(tooManyPELsLimit, allCategories, hwIsoIDs, obmcLogIDs);
     }
 
     if (!obmcLogIDs.empty())
@@ -691,9 +1680,36 @@ std::vector<uint32_t> Repository::prune(
     return obmcLogIDs;
 }
 
+size_t Repository::pruneCategory(const PELAttributes& pel)
+{
+    bool bmcPEL = CreatorID::openBMC == static_cast<CreatorID>(pel.creator);
+
+    return (bmcPEL ? 0 : 2) + (isServiceableSev(pel) ? 1 : 0);
+}
+
+size_t Repository::prunePass(const PELAttributes& pel)
+{
+    if (pel.hmcState == TransmissionState::acked)
+    {
+        return 0;
+    }
+
+    if (pel.hostState == TransmissionState::acked)
+    {
+        return 1;
+    }
+
+    if (pel.hostState == TransmissionState::sent)
+    {
+        return 2;
+    }
+
+    return 3;
+}
+
 void Repository::removePELs(const IsOverLimitFunc& isOverLimit,
-                            const IsPELTypeFunc& isPELType,
-                            const std::vector<uint32_t>& idsWithHwIsoEntry,
+                            std::span<const size_t> categories,
+                            const std::set<uint32_t>& keepIDs,
                             std::vector<uint32_t>& removedBMCLogIDs)
 {
     if (!isOverLimit())
@@ -701,66 +1717,66 @@ void Repository::removePELs(const IsOverLimitFunc& isOverLimit,
         return;
     }
 
-    auto attributes = getAllPELAttributes(SortOrder::ascending);
-
     // Make 4 passes on the PELs, stopping as soon as isOverLimit
     // returns false.
     //   Pass 1: only delete HMC acked PELs
     //   Pass 2: only delete OS acked PELs
     //   Pass 3: only delete PHYP sent PELs
     //   Pass 4: delete all PELs
-    static const std::vector<std::function<bool(const PELAttributes& pel)>>
-        stateChecks{[](const auto& pel) {
-                        return pel.hmcState == TransmissionState::acked;
-                    },
-
-                    [](const auto& pel) {
-                        return pel.hostState == TransmissionState::acked;
-                    },
-
-                    [](const auto& pel) {
-                        return pel.hostState == TransmissionState::sent;
-                    },
+    // Each PEL is already in the eviction list for the first pass that
+    // can remove it, so a pass just takes PELs off the front of its
+    // lists, merging them oldest first when there is more than one
+    // category.
+    for (size_t pass = 0; pass < numPrunePasses; pass++)
+    {
+        std::vector<std::pair<EvictionList::const_iterator,
+                              EvictionList::const_iterator>>
+            cursors;
 
-                    [](const auto& /*pel*/) { return true; }};
+        for (auto category : categories)
+        {
+            const auto& list = _evictionOrder[category][pass];
+            cursors.emplace_back(list.begin(), list.end());
+        }
 
-    for (const auto& stateCheck : stateChecks)
-    {
-        for (auto it = attributes.begin(); it != attributes.end();)
+        while (true)
         {
-            const auto& pel = it->get();
-            if (isPELType(pel.second) && stateCheck(pel.second))
-            {
-                auto removedID = pel.first.obmcID.id;
+            std::optional<size_t> oldest;
 
-                auto idFound = std::find(idsWithHwIsoEntry.begin(),
-                                         idsWithHwIsoEntry.end(), removedID);
-                if (idFound != idsWithHwIsoEntry.end())
+            for (size_t i = 0; i < cursors.size(); i++)
+            {
+                auto& [next, end] = cursors[i];
+                while ((next != end) &&
+                       keepIDs.contains((*next)->first.obmcID.id))
                 {
-                    ++it;
-                    continue;
+                    ++next;
                 }
 
-                remove(pel.first);
-
-                removedBMCLogIDs.push_back(removedID);
-
-                attributes.erase(it);
-
-                if (!isOverLimit())
+                if ((next != end) &&
+                    (!oldest || OlderFirst{}(*next, *cursors[*oldest].first)))
                 {
-                    break;
+                    oldest = i;
                 }
             }
-            else
+
+            if (!oldest)
             {
-                ++it;
+                break;
             }
-        }
 
-        if (!isOverLimit())
-        {
-            break;
+            // Move past the PEL before removing it takes it out of
+            // the list.
+            auto id = (*cursors[*oldest].first)->first;
+            ++cursors[*oldest].first;
+
+            remove(id);
+
+            removedBMCLogIDs.push_back(id.obmcID.id);
+
+            if (!isOverLimit())
+            {
+                return;
+            }
         }
     }
 }
@@ -771,7 +1787,7 @@ void Repository::archivePEL(const PEL& pel)
     {
         auto path = _archivePath / getPELFilename(pel.id(), pel.commitTime());
 
-        write(pel, path);
+        writeFile(pel, path, !_groupCommit);
 
         _archiveSize += getFileDiskSize(path);
     }
@@ -790,16 +1806,13 @@ std::optional<std::tuple<Repository::LogID, Repository::PELAttributes,
         return std::nullopt;
     }
 
-    std::ifstream file{path, std::ios::in | std::ios::binary};
-    if (!file.good())
+    std::vector<uint8_t> data;
+    if (!readFile(path, data))
     {
         lg2::error("Failed to open PEL file: {FILE}", "FILE", path.string());
         return std::nullopt;
     }
 
-    std::vector<uint8_t> data{std::istreambuf_iterator<char>(file),
-                              std::istreambuf_iterator<char>()};
-
     auto pel = std::make_shared<PEL>(data);
     if (!pel->valid())
     {
@@ -857,7 +1870,8 @@ bool Repository::completePELLink(uint32_t obmcLogID)
 
     auto& [key, attrs, pel] = it->second;
 
-    _pelAttributes.emplace(key, attrs);
+    addPELAttributes(key, attrs);
+    updateIndex(key, &attrs);
     updateRepoStats(attrs, true);
     processAddCallbacks(*pel);
 
@@ -884,7 +1898,10 @@ bool Repository::updatePELFromFile(const LogID& existingKey,
 
     auto& [key, attrs, pel] = *result;
 
+    removeFromEvictionOrder(it);
     it->second = attrs;
+    addToEvictionOrder(it);
+    updateIndex(it->first, &it->second);
     return true;
 }
 
@@ -2,11 +2,15 @@
 #include "bcd_time.hpp"
 #include "paths.hpp"
 #include "pel.hpp"
+#include "segment_store.hpp"
 
 #include <algorithm>
 #include <bitset>
 #include <filesystem>
 #include <map>
+#include <memory>
+#include <set>
+#include <span>
 
 namespace openpower
 {
@@ -132,9 +136,18 @@ class Repository
         {}
     };
 
+    /**
+     * @brief How the PEL data is stored.
+     */
+    enum class Storage
+    {
+        files,
+        segments
+    };
+
     Repository() = delete;
     ~Repository() = default;
-    Repository(const Repository&) = default;
+    Repository(const Repository&) = delete;
     Repository& operator=(const Repository&) = delete;
     Repository(Repository&&) = delete;
     Repository& operator=(Repository&&) = delete;
@@ -155,9 +168,14 @@ class Repository
      * @param[in] repoSize - The maximum amount of space to use for PELs,
      *                       in bytes
      * @param[in] maxNumPELs - The maximum number of PELs to allow
+     * @param[in] storage - If each PEL is stored in its own file, or
+     *                      appended to the segments of a SegmentStore.
+     *                      With segments, removed PELs aren't archived
+     *                      and the PEL paths don't exist, but are still
+     *                      used to sort the PELs.
      */
     Repository(const std::filesystem::path& basePath, size_t repoSize,
-               size_t maxNumPELs);
+               size_t maxNumPELs, Storage storage = Storage::files);
 
     /**
      * @brief Adds a PEL to the repository
@@ -181,6 +199,20 @@ class Repository
      */
     std::optional<LogID> remove(const LogID& id);
 
+    /**
+     * @brief Removes multiple PELs from the repository
+     *
+     * This is the same as calling remove() for each ID, except that if
+     * at least as many PELs are removed as are left, the index file is
+     * rewritten once instead of having a record appended for each one.
+     *
+     * @param[in] ids - the IDs of the PELs to remove
+     *
+     * @return std::vector<LogID> - The LogIDs of the PELs that were
+     *                              removed
+     */
+    std::vector<LogID> remove(const std::vector<LogID>& ids);
+
     /**
      * @brief Generates the filename to use for the PEL ID and BCDTime.
      *
@@ -469,6 +501,91 @@ class Repository
      */
     bool updatePEL(const std::filesystem::path& path, PELUpdateFunc updateFunc);
 
+    /**
+     * @brief Overwrites bytes at a fixed offset in a PEL file, without
+     *        reading and rewriting the whole PEL like updatePEL() does.
+     *
+     * The Private Header and User Header are read and validated first,
+     * and must be for the expected PEL ID.  The new bytes must lie within
+     * those two headers, where every field is at a fixed offset.
+     *
+     * Only the changed bytes are written, so a crash can't leave the file
+     * truncated.  The caller is responsible for keeping the PELAttributes
+     * in sync.
+     *
+     * @param[in] path - The file path to use
+     * @param[in] pelID - The PEL ID the file must contain
+     * @param[in] offset - The offset in the PEL of the bytes to write
+     * @param[in] bytes - The new bytes
+     *
+     * @return bool - If the headers were valid and the bytes were written.
+     */
+    bool patchPEL(const std::filesystem::path& path, uint32_t pelID,
+                  size_t offset, std::span<const uint8_t> bytes);
+
+    /**
+     * @brief Turns group commit on or off for new PELs.
+     *
+     * Every PEL file is written to a temporary file and then linked or
+     * renamed into place, so a PEL is never seen partially written.
+     * Normally a new PEL is also synced to disk before add() returns.
+     * With group commit on, that is left to sync(), so that all the PELs
+     * added in a short window share a single sync.  Until then a power
+     * loss can lose those new PELs, but never a PEL that was already
+     * synced.  Rewrites of existing PELs are always synced.
+     *
+     * @param[in] enable - If group commit should be used
+     */
+    void setGroupCommit(bool enable)
+    {
+        _groupCommit = enable;
+        if (!enable)
+        {
+            sync();
+        }
+    }
+
+    /**
+     * @brief Says if the space used by removed PELs should be reclaimed
+     *        with compact().
+     *
+     * Only ever true when the PELs are stored in segments.
+     *
+     * @return bool - If compaction is needed
+     */
+    bool compactionNeeded() const
+    {
+        return _segments && _segments->compactionNeeded();
+    }
+
+    /**
+     * @brief Reclaims the space used by removed PELs in the segments.
+     */
+    void compact()
+    {
+        if (_segments)
+        {
+            _segments->compact();
+        }
+    }
+
+    /**
+     * @brief Syncs the PELs added since the last sync to disk.
+     *
+     * Only does anything in group commit mode.
+     */
+    void sync();
+
+    /**
+     * @brief Says if there are added PELs that haven't been synced yet.
+     *
+     * @return bool - If sync() has work to do
+     */
+    bool syncPending() const
+    {
+        return _syncPending;
+    }
+
     /**
      * @brief Imports a PEL from disk into the repository.
      *
@@ -506,6 +623,9 @@ class Repository
     /**
      * @brief Finds an entry in the _pelAttributes map.
      *
+     * Uses the PEL ID if it is set, otherwise looks up the PEL ID
+     * using the OpenBMC log ID index.
+     *
      * @param[in] id - the ID (either the pel ID, OBMC ID, or both)
      *
      * @return an iterator to the entry
@@ -513,10 +633,43 @@ class Repository
     std::map<LogID, PELAttributes>::const_iterator findPEL(
         const LogID& id) const
     {
-        return std::find_if(_pelAttributes.begin(), _pelAttributes.end(),
-                            [&id](const auto& a) { return a.first == id; });
+        if (id.pelID.id != 0)
+        {
+            return _pelAttributes.find(id);
+        }
+
+        if (id.obmcID.id != 0)
+        {
+            if (auto it = _obmcIDIndex.lower_bound({id.obmcID.id, 0});
+                (it != _obmcIDIndex.end()) && (it->first == id.obmcID.id))
+            {
+                return _pelAttributes.find(LogID{LogID::Pel{it->second}});
+            }
+        }
+
+        return _pelAttributes.end();
     }
 
+    /**
+     * @brief Adds an entry to the _pelAttributes map and the
+     *        OpenBMC log ID index.
+     *
+     * @param[in] id - the LogID with both IDs filled in
+     * @param[in] attributes - the PEL attributes
+     *
+     * @return bool - true if it was added, false if the PEL ID
+     *                was already present
+     */
+    bool addPELAttributes(const LogID& id, const PELAttributes& attributes);
+
+    /**
+     * @brief Removes an entry from the _pelAttributes map and the
+     *        OpenBMC log ID index.
+     *
+     * @param[in] it - the iterator to the entry to remove
+     */
+    void erasePELAttributes(std::map<LogID, PELAttributes>::const_iterator it);
+
     /**
      * @brief Call any subscribed functions for new PELs
      *
@@ -532,20 +685,112 @@ class Repository
     void processDeleteCallbacks(uint32_t id) const;
 
     /**
-     * @brief Restores the _pelAttributes map on startup based on the existing
-     *        PEL data files.
+     * @brief Restores the _pelAttributes map on startup, from the index
+     *        file if it matches the PEL files and otherwise from the
+     *        PEL data files.  Then writes a new index file.
+     *
+     * When the PELs are in segments, they are read instead.
      */
     void restore();
 
+    /**
+     * @brief Restores the _pelAttributes map based on the existing
+     *        PEL data files.
+     */
+    void restoreFromFiles();
+
+    /**
+     * @brief Moves any PEL files in the logs directory, such as ones
+     *        written before segments were used, into the segments.
+     *
+     * A file that can't be moved is left alone so that it's tried
+     * again on the next start.
+     */
+    void importPELFiles();
+
+    /**
+     * @brief Restores the _pelAttributes map from the PELs in the
+     *        segments.
+     */
+    void restoreFromSegments();
+
+    /**
+     * @brief Restores the _pelAttributes map from the index file.
+     *
+     * Fails if the index file is missing, has a bad checksum, or doesn't
+     * have the same PELs as the log directory.
+     *
+     * @return bool - If the index file was used
+     */
+    bool restoreFromIndex();
+
+    /**
+     * @brief Removes a PEL without updating the index file.
+     *
+     * @param[in] id - the ID (either the pel ID, OBMC ID, or both) to remove
+     *
+     * @return std::optional<LogID> - The LogID of the removed PEL
+     */
+    std::optional<LogID> removePEL(const LogID& id);
+
+    /**
+     * @brief Rewrites the index file with the contents of _pelAttributes.
+     */
+    void writeIndex();
+
+    /**
+     * @brief Appends a record to the index file for a PEL that was added,
+     *        changed, or removed.
+     *
+     * If the write fails the index file is removed, so that the next
+     * restore uses the PEL files.
+     *
+     * @param[in] id - The PEL's LogID
+     * @param[in] attributes - The PEL's new attributes, or nullptr if it
+     *                         was removed.
+     */
+    void updateIndex(const LogID& id, const PELAttributes* attributes);
+
+    /**
+     * @brief Stores a PEL, either in the segments or in the file at path.
+     *
+     * @param[in] pel - The PEL to write
+     * @param[in] path - The PEL's path
+     * @param[in] sync - If the PEL should be synced to disk before
+     *                   returning
+     *
+     * Throws exceptions on failures.
+     */
+    void write(const PEL& pel, const std::filesystem::path& path,
+               bool sync = true);
+
     /**
      * @brief Stores a PEL object in the filesystem.
      *
+     * The data is written to a temporary file first, which then replaces
+     * the file at path, so the file at path is never partially written.
+     *
      * @param[in] pel - The PEL to write
      * @param[in] path - The file to write to
+     * @param[in] sync - If the data and directory entry should be synced
+     *                   to disk before returning
      *
      * Throws exceptions on failures.
      */
-    void write(const PEL& pel, const std::filesystem::path& path);
+    void writeFile(const PEL& pel, const std::filesystem::path& path,
+                   bool sync);
+
+    /**
+     * @brief Reads a PEL's data, either from the segments or from the
+     *        file at path, reusing the buffer's memory.
+     *
+     * @param[in] path - The PEL's path
+     * @param[out] data - Filled in with the PEL data
+     *
+     * @return bool - false if the PEL couldn't be read, with errno set
+     */
+    bool readPEL(const std::filesystem::path& path,
+                 std::vector<uint8_t>& data) const;
 
     /**
      * @brief Updates the repository statistics after a PEL is
@@ -556,31 +801,78 @@ class Repository
      */
     void updateRepoStats(const PELAttributes& pel, bool pelAdded);
 
-    enum class SortOrder
+    /**
+     * @brief The number of categories PELs are pruned by, which are in
+     *        order: BMC informational, BMC serviceable, non-BMC
+     *        informational, and non-BMC serviceable.
+     */
+    static constexpr size_t numPruneCategories = 4;
+
+    /**
+     * @brief The number of passes removePELs() makes on a category.
+     */
+    static constexpr size_t numPrunePasses = 4;
+
+    /**
+     * @brief Returns the prune category of a PEL.
+     *
+     * @param[in] pel - The PEL attributes
+     *
+     * @return size_t - The category, from 0 to numPruneCategories - 1
+     */
+    static size_t pruneCategory(const PELAttributes& pel);
+
+    /**
+     * @brief Returns the first pass of removePELs() that can remove a
+     *        PEL, based on its transmission states.
+     *
+     * @param[in] pel - The PEL attributes
+     *
+     * @return size_t - The pass, from 0 to numPrunePasses - 1
+     */
+    static size_t prunePass(const PELAttributes& pel);
+
+    using AttributesIterator = std::map<LogID, PELAttributes>::const_iterator;
+
+    /**
+     * @brief Orders _pelAttributes entries oldest first, which is the
+     *        order of their file names.
+     */
+    struct OlderFirst
     {
-        ascending,
-        descending
+        bool operator()(const AttributesIterator& left,
+                        const AttributesIterator& right) const
+        {
+            return left->second.path < right->second.path;
+        }
     };
 
+    using EvictionList = std::set<AttributesIterator, OlderFirst>;
+
+    /**
+     * @brief Adds a _pelAttributes entry to the eviction list for its
+     *        prune category and pass.
+     *
+     * @param[in] it - The entry
+     */
+    void addToEvictionOrder(AttributesIterator it);
+
     /**
-     * @brief Returns a vector of all the _pelAttributes entries sorted
-     *        as specified
+     * @brief Removes a _pelAttributes entry from its eviction list.
      *
-     * @param[in] order - If the PELs should be returned in ascending
-     *                    (oldest first) or descending order.
+     * Must be called before changing the path or transmission states
+     * in the entry, with addToEvictionOrder() called after.
      *
-     * @return std::vector<AttributesReference> - The sorted vector of
-     *         references to the pair<LogID, PELAttributes> entries of
-     *         _pelAttributes.
+     * @param[in] it - The entry
      */
-    std::vector<AttributesReference> getAllPELAttributes(SortOrder order) const;
+    void removeFromEvictionOrder(AttributesIterator it);
 
     using IsOverLimitFunc = std::function<bool()>;
-    using IsPELTypeFunc = std::function<bool(const PELAttributes&)>;
 
     /**
-     * @brief Makes 4 passes on the PELs that meet the IsPELTypeFunc
-     *        criteria removing PELs until IsOverLimitFunc returns false.
+     * @brief Makes 4 passes on the PELs in the categories passed in,
+     *        removing them oldest first until IsOverLimitFunc returns
+     *        false.
      *
      *   Pass 1: only delete HMC acked PELs
      *   Pass 2: only delete Os acked PELs
@@ -590,17 +882,16 @@ class Repository
      * @param[in] isOverLimit - The bool(void) function that should
      *                          return true if PELs still need to be
      *                           removed.
-     * @param[in] isPELType - The bool(const PELAttributes&) function
-     *                         used to select the PELs to operate on.
-     * @param[in] ids - The OpenBMC event log Ids with hardware isolation
-     *                   entry.
+     * @param[in] categories - The prune categories to remove PELs from
+     * @param[in] keepIDs - The OpenBMC event log IDs of PELs that must
+     *                      not be removed.
      *
      * @param[out] removedBMCLogIDs - The OpenBMC event log IDs of the
      *                                removed PELs.
      */
     void removePELs(const IsOverLimitFunc& isOverLimit,
-                    const IsPELTypeFunc& isPELType,
-                    const std::vector<uint32_t>& idsWithHwIsoEntry,
+                    std::span<const size_t> categories,
+                    const std::set<uint32_t>& keepIDs,
                     std::vector<uint32_t>& removedBMCLogIDs);
 
     /**
@@ -627,6 +918,28 @@ class Repository
      */
     std::map<LogID, PELAttributes> _pelAttributes;
 
+    /**
+     * @brief An index of OpenBMC log ID and PEL ID pairs, so that PELs
+     *        can be found in _pelAttributes by either ID without a scan.
+     *
+     * If more than one PEL has the same OpenBMC log ID, the one with the
+     * lowest PEL ID is found, the same as a scan would.
+     *
+     * Must be kept in sync with _pelAttributes, so only modify them
+     * using addPELAttributes() and erasePELAttributes().
+     */
+    std::set<std::pair<uint32_t, uint32_t>> _obmcIDIndex;
+
+    /**
+     * @brief The _pelAttributes entries in the order prune() removes
+     *        them, by prune category and then by pass, so it doesn't
+     *        have to sort all the PELs every time.
+     *
+     * Kept up to date by addPELAttributes() and erasePELAttributes().
+     */
+    std::array<std::array<EvictionList, numPrunePasses>, numPruneCategories>
+        _evictionOrder;
+
     /**
      * @brief Subscriptions for new PELs.
      */
@@ -669,6 +982,36 @@ class Repository
      */
     uint64_t _archiveSize = 0;
 
+    /**
+     * @brief The file containing a record of the PEL attributes for
+     *        every add, change, and remove, so that restore() doesn't
+     *        have to read every PEL.
+     */
+    const std::filesystem::path _indexPath;
+
+    /**
+     * @brief Where the PELs are stored when using segments, and
+     *        nullptr when using a file per PEL.
+     */
+    std::unique_ptr<SegmentStore> _segments;
+
+    /**
+     * @brief If new PELs are synced to disk by sync() instead of
+     *        when they are added.
+     */
+    bool _groupCommit = false;
+
+    /**
+     * @brief If there are new PELs waiting for sync().
+     */
+    bool _syncPending = false;
+
+    /**
+     * @brief The number of records appended to the index file since it
+     *        was last rewritten.
+     */
+    size_t _indexRecords = 0;
+
     /**
      * @brief Pending PELs awaiting event log link before adding to repository.
      *        Map key: OpenBMC log ID
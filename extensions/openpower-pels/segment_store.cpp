@@ -0,0 +1,645 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "segment_store.hpp"
+
+#include "crc32.hpp"
+#include "stream.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+#include <xyz/openbmc_project/Common/File/error.hpp>
+
+#include <algorithm>
+#include <format>
+#include <set>
+#include <tuple>
+
+namespace openpower
+{
+namespace pels
+{
+
+namespace fs = std::filesystem;
+namespace file_error = sdbusplus::xyz::openbmc_project::Common::File::Error;
+
+namespace
+{
+
+/**
+ * @brief The segment record types.
+ */
+enum class RecordType : uint8_t
+{
+    pel = 1,
+    tombstone = 2
+};
+
+constexpr auto segmentExtension = ".seg";
+
+/**
+ * @brief The size of the record header fields the header CRC covers.
+ */
+constexpr size_t headerCRCFieldsSize = 9;
+
+/**
+ * @brief Writes all of the data to a file at an offset.
+ *
+ * @param[in] fd - The file descriptor
+ * @param[in] data - The data to write
+ * @param[in] offset - The offset in the file
+ *
+ * @return bool - false on failure, with errno set
+ */
+bool pwriteAll(int fd, std::span<const uint8_t> data, off_t offset)
+{
+    while (!data.empty())
+    {
+        auto rc = pwrite(fd, data.data(), data.size(), offset);
+        if (rc < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+
+        data = data.subspan(rc);
+        offset += rc;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Reads a file at an offset until the buffer is full.
+ *
+ * @param[in] fd - The file descriptor
+ * @param[out] data - The buffer to fill
+ * @param[in] offset - The offset in the file
+ *
+ * @return bool - false on failure or end of file, with errno set
+ */
+bool preadAll(int fd, std::span<uint8_t> data, off_t offset)
+{
+    while (!data.empty())
+    {
+        auto rc = pread(fd, data.data(), data.size(), offset);
+        if (rc < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+
+        if (rc == 0)
+        {
+            errno = ENODATA;
+            return false;
+        }
+
+        data = data.subspan(rc);
+        offset += rc;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Syncs a directory, so that new entries in it are on disk.
+ *
+ * @param[in] dir - The directory
+ */
+void syncDir(const fs::path& dir)
+{
+    int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if ((fd < 0) || (fsync(fd) != 0))
+    {
+        auto e = errno;
+        lg2::error("Unable to sync PEL directory {DIR}, errno = {ERRNO}",
+                   "DIR", dir, "ERRNO", e);
+    }
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+}
+
+} // namespace
+
+SegmentStore::SegmentStore(const fs::path& dir, size_t segmentSize,
+                           size_t sizeLimit) :
+    _dir(dir), _segmentSize(segmentSize), _sizeLimit(sizeLimit)
+{
+    if (!fs::exists(_dir))
+    {
+        fs::create_directories(_dir);
+    }
+
+    for (const auto& dirEntry : fs::directory_iterator(_dir))
+    {
+        const auto& path = dirEntry.path();
+        if (!dirEntry.is_regular_file() ||
+            (path.extension() != segmentExtension))
+        {
+            continue;
+        }
+
+        uint32_t number = 0;
+        try
+        {
+            number = std::stoul(path.stem().string(), nullptr, 16);
+        }
+        catch (const std::exception&)
+        {
+            lg2::error("Unexpected file {FILE} in PEL segment directory",
+                       "FILE", path);
+            continue;
+        }
+
+        int fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+        if (fd < 0)
+        {
+            auto e = errno;
+            lg2::error("Unable to open PEL segment {FILE}, errno = {ERRNO}",
+                       "FILE", path, "ERRNO", e);
+        }
+
+        _segments.emplace(number, Segment{fd, 0, 0, fd >= 0});
+    }
+
+    // Records in later segments replace those in earlier ones, so
+    // they must be read in order.
+    for (auto& [number, segment] : _segments)
+    {
+        if (segment.readable)
+        {
+            restoreSegment(number, segment);
+        }
+    }
+
+    for (const auto& [id, location] : _index)
+    {
+        _segments.at(location.segment).liveSize +=
+            recordHeaderSize + location.size;
+    }
+}
+
+SegmentStore::~SegmentStore()
+{
+    for (const auto& [number, segment] : _segments)
+    {
+        if (segment.fd >= 0)
+        {
+            close(segment.fd);
+        }
+    }
+}
+
+void SegmentStore::restoreSegment(uint32_t number, Segment& segment)
+{
+    std::vector<uint8_t> data;
+
+    struct stat statData{};
+    if (fstat(segment.fd, &statData) == 0)
+    {
+        data.resize(statData.st_size);
+    }
+
+    if ((data.size() != static_cast<size_t>(statData.st_size)) ||
+        !preadAll(segment.fd, data, 0))
+    {
+        auto e = errno;
+        lg2::error("Unable to read PEL segment {FILE}, errno = {ERRNO}",
+                   "FILE", segmentPath(number), "ERRNO", e);
+        segment.readable = false;
+        return;
+    }
+
+    size_t offset = 0;
+    while (data.size() - offset >= recordHeaderSize)
+    {
+        Stream stream{data, offset};
+        uint8_t type = 0;
+        uint32_t id = 0;
+        uint32_t size = 0;
+        uint32_t crc = 0;
+        uint32_t dataCRC = 0;
+        stream >> type >> id >> size >> crc >> dataCRC;
+
+        if ((crc != crc32(data.data() + offset, headerCRCFieldsSize)) ||
+            (size > data.size() - offset - recordHeaderSize))
+        {
+            break;
+        }
+
+        auto dataOffset = offset + recordHeaderSize;
+
+        if (type == static_cast<uint8_t>(RecordType::pel))
+        {
+            if (dataCRC == crc32(data.data() + dataOffset, size))
+            {
+                _index.insert_or_assign(
+                    id, Location{number, static_cast<uint32_t>(dataOffset),
+                                 size});
+            }
+            else
+            {
+                lg2::error("Bad data for PEL {ID} in PEL segment {FILE}, "
+                           "removing it",
+                           "ID", lg2::hex, id, "FILE", segmentPath(number));
+                _index.erase(id);
+            }
+        }
+        else if ((type == static_cast<uint8_t>(RecordType::tombstone)) &&
+                 (size == 0))
+        {
+            _index.erase(id);
+        }
+        else
+        {
+            break;
+        }
+
+        offset += recordHeaderSize + size;
+    }
+
+    if (offset != data.size())
+    {
+        // Probably a record that was being written when the power was
+        // lost, so drop it.
+        lg2::error("Bad record in PEL segment {FILE} at offset {OFFSET}, "
+                   "removing the rest of the segment",
+                   "FILE", segmentPath(number), "OFFSET", offset);
+        if (ftruncate(segment.fd, offset) != 0)
+        {
+            auto e = errno;
+            lg2::error("Unable to truncate PEL segment {FILE}, "
+                       "errno = {ERRNO}",
+                       "FILE", segmentPath(number), "ERRNO", e);
+        }
+    }
+
+    segment.size = offset;
+}
+
+uint32_t SegmentStore::activeSegment(size_t recordSize)
+{
+    uint32_t number = 0;
+
+    if (!_segments.empty())
+    {
+        const auto& [last, segment] = *_segments.rbegin();
+        if (segment.readable &&
+            ((segment.size == 0) || (segment.size + recordSize <= _segmentSize)))
+        {
+            return last;
+        }
+
+        number = last + 1;
+    }
+
+    auto path = segmentPath(number);
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        auto e = errno;
+        lg2::error("Unable to create PEL segment {FILE}, errno = {ERRNO}",
+                   "FILE", path, "ERRNO", e);
+        throw file_error::Open();
+    }
+
+    syncDir(_dir);
+
+    _segments.emplace(number, Segment{fd, 0, 0});
+    return number;
+}
+
+SegmentStore::Location SegmentStore::append(
+    uint8_t type, uint32_t id, std::span<const uint8_t> data, bool sync)
+{
+    std::vector<uint8_t> record;
+    record.reserve(recordHeaderSize + data.size());
+
+    Stream stream{record};
+    stream << type << id << static_cast<uint32_t>(data.size());
+    stream << crc32(record.data(), record.size());
+    stream << crc32(data.data(), data.size());
+    record.insert(record.end(), data.begin(), data.end());
+
+    auto number = activeSegment(record.size());
+    auto& segment = _segments.at(number);
+
+    if (!pwriteAll(segment.fd, record, segment.size) ||
+        (sync && (fdatasync(segment.fd) != 0)))
+    {
+        // Don't leave part of a record behind.
+        auto e = errno;
+        lg2::error("Unable to write to PEL segment {FILE}, errno = {ERRNO}",
+                   "FILE", segmentPath(number), "ERRNO", e);
+        if (ftruncate(segment.fd, segment.size) != 0)
+        {
+            segment.size = std::max(segment.size, _segmentSize);
+        }
+        throw file_error::Write();
+    }
+
+    Location location{number,
+                      static_cast<uint32_t>(segment.size + recordHeaderSize),
+                      static_cast<uint32_t>(data.size())};
+    segment.size += record.size();
+
+    return location;
+}
+
+size_t SegmentStore::add(uint32_t id, std::span<const uint8_t> data,
+                         bool sync)
+{
+    auto location =
+        append(static_cast<uint8_t>(RecordType::pel), id, data, sync);
+
+    if (auto old = _index.find(id); old != _index.end())
+    {
+        _segments.at(old->second.segment).liveSize -=
+            recordHeaderSize + old->second.size;
+    }
+
+    _index.insert_or_assign(id, location);
+
+    auto size = recordHeaderSize + data.size();
+    _segments.at(location.segment).liveSize += size;
+
+    return size;
+}
+
+bool SegmentStore::remove(uint32_t id)
+{
+    auto it = _index.find(id);
+    if (it == _index.end())
+    {
+        return false;
+    }
+
+    try
+    {
+        append(static_cast<uint8_t>(RecordType::tombstone), id, {}, false);
+    }
+    catch (const std::exception& e)
+    {
+        lg2::error("Unable to remove PEL {ID} from segment: {ERROR}", "ID",
+                   lg2::hex, id, "ERROR", e);
+        return false;
+    }
+
+    _segments.at(it->second.segment).liveSize -=
+        recordHeaderSize + it->second.size;
+    _index.erase(it);
+
+    return true;
+}
+
+std::vector<uint32_t> SegmentStore::ids() const
+{
+    std::vector<std::pair<Location, uint32_t>> locations;
+    locations.reserve(_index.size());
+
+    for (const auto& [id, location] : _index)
+    {
+        locations.emplace_back(location, id);
+    }
+
+    std::ranges::sort(locations, [](const auto& left, const auto& right) {
+        return std::tie(left.first.segment, left.first.offset) <
+               std::tie(right.first.segment, right.first.offset);
+    });
+
+    std::vector<uint32_t> ids;
+    ids.reserve(locations.size());
+    for (const auto& [location, id] : locations)
+    {
+        ids.push_back(id);
+    }
+
+    return ids;
+}
+
+bool SegmentStore::read(uint32_t id, std::vector<uint8_t>& data) const
+{
+    auto it = _index.find(id);
+    if (it == _index.end())
+    {
+        errno = ENOENT;
+        return false;
+    }
+
+    data.resize(it->second.size);
+    return preadAll(_segments.at(it->second.segment).fd, data,
+                    it->second.offset);
+}
+
+size_t SegmentStore::diskSize(uint32_t id) const
+{
+    auto it = _index.find(id);
+    if (it == _index.end())
+    {
+        return 0;
+    }
+
+    return recordHeaderSize + it->second.size;
+}
+
+bool SegmentStore::patch(uint32_t id, size_t offset,
+                         std::span<const uint8_t> bytes)
+{
+    auto it = _index.find(id);
+    if ((it == _index.end()) || (offset + bytes.size() > it->second.size))
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> data;
+    if (!read(id, data))
+    {
+        auto e = errno;
+        lg2::error("Unable to read PEL {ID} to patch it, errno = {ERRNO}",
+                   "ID", lg2::hex, id, "ERRNO", e);
+        return false;
+    }
+
+    std::ranges::copy(bytes, data.begin() + offset);
+
+    std::vector<uint8_t> crc;
+    Stream stream{crc};
+    stream << crc32(data.data(), data.size());
+
+    // The CRC is the last field of the record header, right before the
+    // data.  It's written after the data, so if the power is lost in
+    // between only this PEL is lost.
+    auto fd = _segments.at(it->second.segment).fd;
+    if (!pwriteAll(fd, bytes, it->second.offset + offset) ||
+        !pwriteAll(fd, crc, it->second.offset - crc.size()))
+    {
+        auto e = errno;
+        lg2::error("Unable to patch PEL {ID} in segment, errno = {ERRNO}",
+                   "ID", lg2::hex, id, "ERRNO", e);
+        return false;
+    }
+
+    return true;
+}
+
+int SegmentStore::getFD(uint32_t id) const
+{
+    std::vector<uint8_t> data;
+    if (!read(id, data))
+    {
+        return -1;
+    }
+
+    int fd = memfd_create("pel", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    // Seal it so the receiver can't change it.
+    if (!pwriteAll(fd, data, 0) ||
+        (fcntl(fd, F_ADD_SEALS,
+               F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) != 0))
+    {
+        auto e = errno;
+        close(fd);
+        errno = e;
+        return -1;
+    }
+
+    return fd;
+}
+
+size_t SegmentStore::totalSize() const
+{
+    size_t size = 0;
+    for (const auto& [number, segment] : _segments)
+    {
+        if (segment.readable)
+        {
+            size += segment.size;
+        }
+    }
+    return size;
+}
+
+bool SegmentStore::compactable(uint32_t number) const
+{
+    return _segments.at(number).readable &&
+           (number != _segments.rbegin()->first);
+}
+
+bool SegmentStore::compactionNeeded() const
+{
+    size_t total = 0;
+    size_t live = 0;
+    size_t reclaimable = 0;
+    for (const auto& [number, segment] : _segments)
+    {
+        if (!segment.readable)
+        {
+            continue;
+        }
+
+        total += segment.size;
+        live += segment.liveSize;
+
+        if (compactable(number))
+        {
+            reclaimable += segment.size - segment.liveSize;
+        }
+    }
+
+    // Allow up to half of the space to be unused, which keeps the
+    // amount of copying down, but not if that puts the segments over
+    // the size limit.
+    return (reclaimable > 0) &&
+           ((total - live > total / 2) || (total > _sizeLimit));
+}
+
+void SegmentStore::compact()
+{
+    std::vector<uint8_t> data;
+
+    while (compactionNeeded())
+    {
+        auto oldest = std::ranges::find_if(_segments, [this](const auto& seg) {
+            return compactable(seg.first);
+        });
+        auto number = oldest->first;
+
+        std::vector<std::pair<uint32_t, uint32_t>> live;
+        for (const auto& [id, location] : _index)
+        {
+            if (location.segment == number)
+            {
+                live.emplace_back(location.offset, id);
+            }
+        }
+        std::ranges::sort(live);
+
+        // Copy the live PELs to the active segment and sync them
+        // before the oldest segment is deleted.
+        std::set<uint32_t> written;
+        try
+        {
+            for (const auto& [offset, id] : live)
+            {
+                if (!read(id, data))
+                {
+                    auto e = errno;
+                    lg2::error("Unable to read PEL {ID} from segment while "
+                               "compacting, errno = {ERRNO}",
+                               "ID", lg2::hex, id, "ERRNO", e);
+                    return;
+                }
+
+                add(id, data, false);
+                written.insert(_index.at(id).segment);
+            }
+        }
+        catch (const std::exception& e)
+        {
+            lg2::error("Unable to compact PEL segments: {ERROR}", "ERROR", e);
+            return;
+        }
+
+        for (auto segment : written)
+        {
+            if (fdatasync(_segments.at(segment).fd) != 0)
+            {
+                auto e = errno;
+                lg2::error("Unable to sync PEL segment {FILE}, "
+                           "errno = {ERRNO}",
+                           "FILE", segmentPath(segment), "ERRNO", e);
+                return;
+            }
+        }
+
+        close(oldest->second.fd);
+        std::error_code ec;
+        fs::remove(segmentPath(number), ec);
+        _segments.erase(oldest);
+    }
+}
+
+fs::path SegmentStore::segmentPath(uint32_t number) const
+{
+    return _dir / std::format("{:08X}{}", number, segmentExtension);
+}
+
+} // namespace pels
+} // namespace openpower
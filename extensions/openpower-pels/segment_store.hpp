@@ -0,0 +1,316 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <filesystem>
+#include <limits>
+#include <map>
+#include <span>
+#include <vector>
+
+namespace openpower
+{
+namespace pels
+{
+
+/**
+ * @class SegmentStore
+ *
+ * Stores PELs by appending them to a few fixed size segment files,
+ * instead of using a file per PEL, which on flash filesystems saves
+ * the inode and metadata writes of every PEL file.
+ *
+ * Each record in a segment is a header followed by the PEL data:
+ *   - uint8_t: The type, 1 = PEL, 2 = tombstone
+ *   - uint32_t: The PEL ID
+ *   - uint32_t: The data size, 0 for a tombstone
+ *   - uint32_t: A CRC-32 of the above fields
+ *   - uint32_t: A CRC-32 of the data
+ *
+ * A record with a bad header CRC can't be skipped over, so it and the
+ * rest of the segment are removed, while a PEL with a bad data CRC is
+ * just dropped.  The data CRC isn't covered by the header CRC, so that
+ * it can be rewritten when a PEL is patched.
+ *
+ * Segments are numbered, and records are only appended to the highest
+ * numbered one.  The newest record for a PEL ID replaces any older ones,
+ * and a tombstone says the PEL was removed.  On startup the segments are
+ * scanned in order to build the in memory index of where each PEL is.
+ *
+ * Space taken by replaced or removed PELs is reclaimed by compact(),
+ * which copies the live PELs out of the oldest segment and deletes it.
+ * Up to half of the space may be unused before that's needed, unless
+ * the segments have grown past a size limit.
+ * Since the oldest segment is always the one compacted, its tombstones
+ * can't refer to a record in an even older segment, and can be dropped.
+ *
+ * A segment that can't be read on startup is kept, but isn't appended
+ * to, compacted, or counted in the sizes.  If it can be read on a later
+ * start, PELs removed in the meantime could come back, which is better
+ * than losing the ones in it.
+ */
+class SegmentStore
+{
+  public:
+    SegmentStore() = delete;
+    SegmentStore(const SegmentStore&) = delete;
+    SegmentStore& operator=(const SegmentStore&) = delete;
+    SegmentStore(SegmentStore&&) = delete;
+    SegmentStore& operator=(SegmentStore&&) = delete;
+
+    /**
+     * @brief The default maximum size of a segment file.
+     */
+    static constexpr size_t defaultSegmentSize = 1024 * 1024;
+
+    /**
+     * @brief The size of a record header.
+     */
+    static constexpr size_t recordHeaderSize = 17;
+
+    /**
+     * @brief Constructor
+     *
+     * Reads the segments in the directory, creating it if necessary.
+     *
+     * @param[in] dir - The directory to keep the segments in
+     * @param[in] segmentSize - The maximum size of a segment file
+     * @param[in] sizeLimit - The size the segments should be compacted
+     *                        down to when they grow past it
+     */
+    explicit SegmentStore(
+        const std::filesystem::path& dir,
+        size_t segmentSize = defaultSegmentSize,
+        size_t sizeLimit = std::numeric_limits<size_t>::max());
+
+    /**
+     * @brief Destructor
+     */
+    ~SegmentStore();
+
+    /**
+     * @brief Adds a PEL, replacing any existing one with the same ID.
+     *
+     * Throws File.Error.Open or File.Error.Write exceptions on failure.
+     *
+     * @param[in] id - The PEL ID
+     * @param[in] data - The PEL data
+     * @param[in] sync - If the data should be synced to disk before
+     *                   returning
+     *
+     * @return size_t - The space the PEL takes up in the segment
+     */
+    size_t add(uint32_t id, std::span<const uint8_t> data, bool sync);
+
+    /**
+     * @brief Removes a PEL by writing a tombstone for it.
+     *
+     * @param[in] id - The PEL ID
+     *
+     * @return bool - If the PEL was found and removed
+     */
+    bool remove(uint32_t id);
+
+    /**
+     * @brief Says if a PEL is in the store.
+     *
+     * @param[in] id - The PEL ID
+     *
+     * @return bool - If it's there
+     */
+    bool contains(uint32_t id) const
+    {
+        return _index.contains(id);
+    }
+
+    /**
+     * @brief Returns the IDs of all the PELs, in the order they were
+     *        stored.
+     *
+     * @return std::vector<uint32_t> - The PEL IDs
+     */
+    std::vector<uint32_t> ids() const;
+
+    /**
+     * @brief Reads a PEL into the buffer passed in, reusing the buffer's
+     *        memory.
+     *
+     * @param[in] id - The PEL ID
+     * @param[out] data - Filled in with the PEL data
+     *
+     * @return bool - false if the PEL isn't there or couldn't be read
+     */
+    bool read(uint32_t id, std::vector<uint8_t>& data) const;
+
+    /**
+     * @brief Returns the space a PEL takes up in its segment.
+     *
+     * @param[in] id - The PEL ID
+     *
+     * @return size_t - The size, or 0 if the PEL isn't there
+     */
+    size_t diskSize(uint32_t id) const;
+
+    /**
+     * @brief Overwrites bytes in a stored PEL, and its data CRC.
+     *
+     * If the power is lost before the CRC is written, the PEL will be
+     * dropped when the segment is read again.
+     *
+     * @param[in] id - The PEL ID
+     * @param[in] offset - The offset in the PEL of the bytes to write
+     * @param[in] bytes - The new bytes, which must be within the PEL
+     *
+     * @return bool - If the bytes were written
+     */
+    bool patch(uint32_t id, size_t offset, std::span<const uint8_t> bytes);
+
+    /**
+     * @brief Returns a file descriptor to a sealed, read only memfd
+     *        holding a copy of a PEL, for passing to other processes.
+     *
+     * The caller must close it.
+     *
+     * @param[in] id - The PEL ID
+     *
+     * @return int - The file descriptor, or -1 on failure
+     */
+    int getFD(uint32_t id) const;
+
+    /**
+     * @brief Says if enough of the space in the segments is taken up by
+     *        replaced or removed PELs that compact() should be called,
+     *        or if the segments are over the size limit and some of
+     *        that space can be reclaimed.
+     *
+     * @return bool - If compaction is needed
+     */
+    bool compactionNeeded() const;
+
+    /**
+     * @brief Reclaims space by copying the live PELs out of the oldest
+     *        segments and deleting them, until compactionNeeded() is
+     *        false.
+     */
+    void compact();
+
+    /**
+     * @brief Returns the total size of the segment files that could be
+     *        read.
+     *
+     * @return size_t - The size
+     */
+    size_t totalSize() const;
+
+  private:
+    /**
+     * @brief Where a PEL is stored.
+     */
+    struct Location
+    {
+        uint32_t segment;
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    /**
+     * @brief A segment file.
+     */
+    struct Segment
+    {
+        int fd;
+        size_t size;
+        size_t liveSize;
+
+        /**
+         * @brief If it could be read on startup.  One that couldn't is
+         *        left alone, in case it can be read on a later start.
+         */
+        bool readable = true;
+    };
+
+    /**
+     * @brief Says if a segment's space can be reclaimed by compact(),
+     *        which isn't the case for the active or unreadable ones.
+     *
+     * @param[in] number - The segment number
+     *
+     * @return bool - If it can be compacted
+     */
+    bool compactable(uint32_t number) const;
+
+    /**
+     * @brief Reads the records in a segment and adds them to the index.
+     *
+     * A truncated record or one with a bad header, and everything
+     * after it, is removed from the segment.  A PEL with bad data is
+     * left out of the index.
+     *
+     * @param[in] number - The segment number
+     * @param[in] segment - The segment
+     */
+    void restoreSegment(uint32_t number, Segment& segment);
+
+    /**
+     * @brief Returns the segment to append a record of the size passed in
+     *        to, starting a new one if the current one is too full.
+     *
+     * @param[in] recordSize - The size of the record
+     *
+     * @return uint32_t - The segment number
+     */
+    uint32_t activeSegment(size_t recordSize);
+
+    /**
+     * @brief Appends a record to the active segment.
+     *
+     * Throws File.Error.Write on failure.
+     *
+     * @param[in] type - The record type
+     * @param[in] id - The PEL ID
+     * @param[in] data - The PEL data
+     * @param[in] sync - If the data should be synced to disk
+     *
+     * @return Location - Where the PEL data was written
+     */
+    Location append(uint8_t type, uint32_t id, std::span<const uint8_t> data,
+                    bool sync);
+
+    /**
+     * @brief Returns the path of a segment file.
+     *
+     * @param[in] number - The segment number
+     *
+     * @return std::filesystem::path - The path
+     */
+    std::filesystem::path segmentPath(uint32_t number) const;
+
+    /**
+     * @brief The directory holding the segments.
+     */
+    const std::filesystem::path _dir;
+
+    /**
+     * @brief The maximum size of a segment.
+     */
+    const size_t _segmentSize;
+
+    /**
+     * @brief The size the segments are compacted down to if they grow
+     *        past it.
+     */
+    const size_t _sizeLimit;
+
+    /**
+     * @brief The segments, by number.
+     */
+    std::map<uint32_t, Segment> _segments;
+
+    /**
+     * @brief Where each PEL is, by PEL ID.
+     */
+    std::map<uint32_t, Location> _index;
+};
+
+} // namespace pels
+} // namespace openpower
@@ -1,4 +1,5 @@
 #include "constants.hpp"
+#include "lg2_commit.hpp"
 
 #include <phosphor-logging/elog.hpp>
 #include <phosphor-logging/lg2.hpp>
@@ -21,7 +22,7 @@ auto _prepareMsg(const char* funcName)
 
     // Transaction id is located at the end of the string separated by a period.
 
-    auto b = sdbusplus::bus::new_default();
+    auto& b = lg2::details::commit_bus();
 
     auto m = b.new_method_call(BUSNAME_LOGGING, OBJ_INTERNAL, IFACE_INTERNAL,
                                funcName);
@@ -33,8 +34,7 @@ uint32_t commit(const char* name)
     auto msg = _prepareMsg("Commit");
     uint64_t id = sdbusplus::server::transaction::get_id();
     msg.append(id, name);
-    auto bus = sdbusplus::bus::new_default();
-    auto reply = bus.call(msg);
+    auto reply = lg2::details::commit_bus().call(msg);
     auto entryID = reply.unpack<uint32_t>();
 
     return entryID;
@@ -45,8 +45,7 @@ uint32_t commit(const char* name, Entry::Level level)
     auto msg = _prepareMsg("CommitWithLvl");
     uint64_t id = sdbusplus::server::transaction::get_id();
     msg.append(id, name, static_cast<uint32_t>(level));
-    auto bus = sdbusplus::bus::new_default();
-    auto reply = bus.call(msg);
+    auto reply = lg2::details::commit_bus().call(msg);
     auto entryID = reply.unpack<uint32_t>();
 
     return entryID;
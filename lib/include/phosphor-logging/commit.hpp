@@ -3,7 +3,9 @@
 #include <sdbusplus/async.hpp>
 #include <sdbusplus/exception.hpp>
 
+#include <functional>
 #include <optional>
+#include <vector>
 
 namespace lg2
 {
@@ -12,20 +14,49 @@ namespace lg2
  *  @param e - The event to commit.
  *  @return The object path of the resulting event.
  *
- *  Note: Similar to elog(), this will use the default dbus connection to
- *  perform the operation.
+ *  Note: Similar to elog(), this will use a connection to the default bus,
+ *  which is kept open between calls, to perform the operation.
  */
 auto commit(sdbusplus::exception::generated_event_base&& e,
             std::optional<int> overrideLevel = std::nullopt)
     -> sdbusplus::object_path;
 
+/** Commit a generated event/error without waiting for the result.
+ *
+ *  @param e - The event to commit.
+ *
+ *  The call to create the event is sent without asking for a reply, so the
+ *  caller doesn't wait for the logging service to create it.  Each call
+ *  still flushes the connection, blocking until the message is written to
+ *  the socket.  Since there is no reply, an error from creating the event
+ *  is never reported.
+ */
+void commit_noreply(sdbusplus::exception::generated_event_base&& e,
+                    std::optional<int> overrideLevel = std::nullopt);
+
+/** Commit a group of generated events/errors with a single call.
+ *
+ *  @param events - The events to commit.
+ *  @return The object paths of the resulting events, in the same order as
+ *          the events.  The path is empty for an event that was filtered.
+ *
+ *  The events are created by one CreateBatch call to the logging service,
+ *  which persists them together, rather than by one Create call each.
+ *  The service rejects a batch with more errors, or more informational
+ *  events, than it keeps, and the exception from the call is thrown.
+ */
+auto commit_batch(
+    std::vector<
+        std::reference_wrapper<sdbusplus::exception::generated_event_base>>
+        events) -> std::vector<sdbusplus::object_path>;
+
 /** Resolve an existing event/error.
  *
  *  @param logPath - The object path of the event to resolve.
  *  @return None.
  *
- *  Note: Similar to elog(), this will use the default dbus connection to
- *  perform the operation.
+ *  Note: Similar to elog(), this will use a connection to the default bus,
+ *  which is kept open between calls, to perform the operation.
  */
 void resolve(const sdbusplus::object_path& logPath);
 
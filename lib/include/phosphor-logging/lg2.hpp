@@ -27,6 +27,11 @@ struct log
     explicit log(const std::source_location& s, const char* msg,
                  details::header_str_conversion_t<Ts&&>... ts)
     {
+        if (!details::level_enabled(S))
+        {
+            return;
+        }
+
         details::log_conversion::start(
             S, s, msg,
             std::forward<details::header_str_conversion_t<Ts&&>>(ts)...);
@@ -2,7 +2,9 @@
 
 #include <phosphor-logging/lg2/level.hpp>
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <source_location>
 
 namespace lg2::details
@@ -22,4 +24,35 @@ namespace lg2::details
  */
 void do_log(level, const std::source_location&, const char*, ...);
 
+/** Bitmask of the levels which currently produce any output. */
+extern std::atomic<uint8_t> enabled_levels;
+
+/** Check if anything would be output for a level.
+ *
+ *  This lets `lg2::log` skip converting its arguments for levels that are
+ *  disabled.
+ *
+ *  @param[in] l - The level to check.
+ */
+inline bool level_enabled(level l)
+{
+    return enabled_levels.load(std::memory_order_relaxed) &
+           (1 << static_cast<int>(l));
+}
+
 } // namespace lg2::details
+
+namespace lg2
+{
+
+/** Set the maximum level to log at.
+ *
+ *  Entries at a higher (less severe) level are discarded before they are
+ *  formatted.  This only writes an atomic, so it is safe to call from a
+ *  signal handler, such as one that turns debug logging on or off.
+ *
+ *  @param[in] level - The maximum level, default is level::debug.
+ */
+void set_level(level);
+
+} // namespace lg2
@@ -2,7 +2,11 @@
 
 #include "lg2_commit.hpp"
 
+#include "constants.hpp"
+
 #include <sys/syslog.h>
+#include <systemd/sd-bus.h>
+#include <unistd.h>
 
 #include <nlohmann/json.hpp>
 #include <phosphor-logging/commit.hpp>
@@ -106,6 +110,71 @@ static auto data_from_json(sdbusplus::exception::generated_event_base& t)
     return result;
 }
 
+sdbusplus::bus_t& commit_bus()
+{
+    // A connection can't be used from multiple threads at once, so each
+    // thread has its own.  This is a private connection rather than the
+    // sd_bus_default() one, since whoever else uses that one may close it.
+    thread_local std::optional<sdbusplus::bus_t> bus;
+    thread_local pid_t owner = 0;
+
+    auto pid = getpid();
+    if (bus && (owner != pid))
+    {
+        // A connection inherited over a fork can't be used or closed by
+        // the child, so just forget about it.
+        bus->release();
+        bus.reset();
+    }
+
+    if (!bus || (sd_bus_is_open(bus->get()) <= 0))
+    {
+        bus.emplace(sdbusplus::bus::new_bus());
+        owner = pid;
+    }
+
+    return *bus;
+}
+
+/* Create the method call to commit an event. */
+static auto create_message(sdbusplus::bus_t& b,
+                           sdbusplus::exception::generated_event_base& t,
+                           int severity) -> sdbusplus::message_t
+{
+    auto m = b.new_method_call(Create::default_service, Create::instance_path,
+                               Create::interface, "Create");
+
+    m.append(t.name(), severity_from_syslog(severity), data_from_json(t));
+
+    return m;
+}
+
+/* Check the event filters, and log the event to the journal if enabled.
+ *
+ * @return false if the event was filtered out.
+ */
+static bool prepare_commit(sdbusplus::exception::generated_event_base& t,
+                           int severity)
+{
+    if ((severity == LOG_INFO) && filterEvent(t.name()))
+    {
+        return false;
+    }
+    else if (filterError(t.name()))
+    {
+        return false;
+    }
+
+    if constexpr (LG2_COMMIT_JOURNAL)
+    {
+        nlohmann::json entry = t.to_json();
+        entry["severity"] = severity;
+        lg2::error("OPENBMC_MESSAGE_ID={DATA}", "DATA", entry.dump());
+    }
+
+    return true;
+}
+
 auto extractEvent(sdbusplus::exception::generated_event_base&& t)
     -> std::tuple<std::string, Entry::Level, std::map<std::string, std::string>>
 {
@@ -118,41 +187,107 @@ auto commit(sdbusplus::exception::generated_event_base&& t,
             std::optional<int> overrideLevel) -> sdbusplus::object_path
 {
     int severity = overrideLevel.value_or(t.severity());
-    // Check event filters first.
-    if ((severity == LOG_INFO) && details::filterEvent(t.name()))
+    if (!details::prepare_commit(t, severity))
     {
         return {};
     }
-    else if (details::filterError(t.name()))
+
+    if constexpr (LG2_COMMIT_DBUS)
     {
-        return {};
+        auto& b = details::commit_bus();
+        auto m = details::create_message(b, t, severity);
+
+        auto reply = b.call(m);
+
+        return reply.unpack<sdbusplus::object_path>();
     }
 
-    if constexpr (LG2_COMMIT_JOURNAL)
+    return {};
+}
+
+void commit_noreply(sdbusplus::exception::generated_event_base&& t,
+                    std::optional<int> overrideLevel)
+{
+    int severity = overrideLevel.value_or(t.severity());
+    if (!details::prepare_commit(t, severity))
     {
-        nlohmann::json entry = t.to_json();
-        entry["severity"] = severity;
-        lg2::error("OPENBMC_MESSAGE_ID={DATA}", "DATA", entry.dump());
+        return;
     }
 
     if constexpr (LG2_COMMIT_DBUS)
     {
-        using details::Create;
+        auto& b = details::commit_bus();
+        auto m = details::create_message(b, t, severity);
 
-        auto b = sdbusplus::bus::new_default();
-        auto m =
-            b.new_method_call(Create::default_service, Create::instance_path,
-                              Create::interface, "Create");
+        // Queue the call without waiting for, or even asking for, a reply.
+        sd_bus_message_set_expect_reply(m.get(), 0);
+        auto r = sd_bus_send(b.get(), m.get(), nullptr);
+        if (r < 0)
+        {
+            throw sdbusplus::exception::SdBusError(-r, "sd_bus_send");
+        }
+
+        // Nothing else processes this connection, so while it is still
+        // authenticating the message would just sit in the write queue
+        // until a later synchronous call.  This waits for the write
+        // only, not for a reply.
+        r = sd_bus_flush(b.get());
+        if (r < 0)
+        {
+            throw sdbusplus::exception::SdBusError(-r, "sd_bus_flush");
+        }
+    }
+}
+
+auto commit_batch(
+    std::vector<
+        std::reference_wrapper<sdbusplus::exception::generated_event_base>>
+        events) -> std::vector<sdbusplus::object_path>
+{
+    using details::AdditionalData_t;
+    using details::Entry;
 
-        m.append(t.name(), details::severity_from_syslog(severity),
-                 details::data_from_json(t));
+    std::vector<sdbusplus::object_path> result(events.size());
+    std::vector<size_t> committed;
+    std::vector<std::tuple<std::string, Entry::Level, AdditionalData_t>> batch;
+
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        auto& t = events[i].get();
+        int severity = t.severity();
+        if (!details::prepare_commit(t, severity))
+        {
+            continue;
+        }
+
+        committed.push_back(i);
+        batch.emplace_back(t.name(), details::severity_from_syslog(severity),
+                           details::data_from_json(t));
+    }
+
+    if constexpr (LG2_COMMIT_DBUS)
+    {
+        if (batch.empty())
+        {
+            return result;
+        }
+
+        auto& b = details::commit_bus();
+        auto m = b.new_method_call(
+            BUSNAME_LOGGING, OBJ_INTERNAL,
+            "xyz.openbmc_project.Logging.Internal.Manager", "CreateBatch");
+        m.append(batch);
 
         auto reply = b.call(m);
+        auto paths = reply.unpack<std::vector<sdbusplus::object_path>>();
 
-        return reply.unpack<sdbusplus::object_path>();
+        for (size_t i = 0; (i < committed.size()) && (i < paths.size()); i++)
+        {
+            result[committed[i]] = std::move(paths[i]);
+        }
     }
 
-    return {};
+    return result;
 }
 
 void resolve(const sdbusplus::object_path& logPath)
@@ -161,7 +296,7 @@ void resolve(const sdbusplus::object_path& logPath)
     {
         using details::Entry;
 
-        auto b = sdbusplus::bus::new_default();
+        auto& b = details::commit_bus();
         auto m = b.new_method_call(Entry::default_service, logPath.str.c_str(),
                                    "org.freedesktop.DBus.Properties", "Set");
         m.append(Entry::interface, "Resolved", std::variant<bool>(true));
@@ -1,4 +1,5 @@
 #pragma once
+#include <sdbusplus/bus.hpp>
 #include <sdbusplus/exception.hpp>
 #include <xyz/openbmc_project/Logging/Entry/client.hpp>
 
@@ -23,4 +24,14 @@ auto extractEvent(sdbusplus::exception::generated_event_base&&)
 bool filterEvent(const std::string&);
 bool filterError(const std::string&);
 
+/** Get the connection used to commit events.
+ *
+ *  Each thread gets its own connection to the default bus, which is kept
+ *  open between calls instead of connecting every time.  It is replaced
+ *  after a fork or if it has been disconnected.
+ *
+ *  @return The calling thread's connection.
+ */
+sdbusplus::bus_t& commit_bus();
+
 } // namespace lg2::details
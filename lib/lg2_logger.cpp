@@ -1,58 +1,178 @@
 #define SD_JOURNAL_SUPPRESS_LOCATION
 
+#include <pthread.h>
 #include <systemd/sd-journal.h>
 #include <unistd.h>
 
 #include <phosphor-logging/lg2.hpp>
 
 #include <algorithm>
-#include <bitset>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cinttypes>
 #include <cstdarg>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <list>
+#include <memory>
 #include <mutex>
 #include <source_location>
+#include <span>
 #include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
 #include <utility>
 #include <vector>
 
 namespace lg2::details
 {
+/** Vector with a fixed amount of inline storage, which only falls back to
+ *  the heap when that runs out. */
+template <typename T, size_t N>
+class small_vector
+{
+  public:
+    void push_back(const T& t)
+    {
+        if (!heap.empty() || count == inline_data.size())
+        {
+            if (heap.empty())
+            {
+                heap.assign(inline_data.begin(), inline_data.end());
+            }
+            heap.push_back(t);
+        }
+        else
+        {
+            inline_data[count] = t;
+        }
+        ++count;
+    }
+
+    T* data()
+    {
+        return heap.empty() ? inline_data.data() : heap.data();
+    }
+
+    size_t size() const
+    {
+        return count;
+    }
+
+    T& operator[](size_t i)
+    {
+        return data()[i];
+    }
+
+  private:
+    std::array<T, N> inline_data;
+    std::vector<T> heap;
+    size_t count = 0;
+};
+
+/** Storage for the "FIELD=value" strings of a journal entry.
+ *
+ *  Fields are built in a fixed buffer.  A field that doesn't fit is moved
+ *  into its own heap allocated string, so the addresses of all fields stay
+ *  stable until the entry has been sent.
+ */
+class field_buffer
+{
+  public:
+    /** Start a new field. */
+    void begin()
+    {
+        start = used;
+        overflowed = false;
+    }
+
+    /** Append to the current field. */
+    void append(std::string_view s)
+    {
+        if (!overflowed && (s.size() > (buffer.size() - used)))
+        {
+            overflow.emplace_back(buffer.data() + start, used - start);
+            used = start;
+            overflowed = true;
+        }
+
+        if (overflowed)
+        {
+            overflow.back().append(s);
+        }
+        else
+        {
+            std::ranges::copy(s, buffer.data() + used);
+            used += s.size();
+        }
+    }
+
+    /** Finish the current field. */
+    std::string_view end()
+    {
+        if (overflowed)
+        {
+            return overflow.back();
+        }
+        return {buffer.data() + start, used - start};
+    }
+
+  private:
+    std::array<char, 4096> buffer;
+    size_t start = 0;
+    size_t used = 0;
+    bool overflowed = false;
+    std::list<std::string> overflow;
+};
+
 /** Convert unsigned to string using format flags. */
-static std::string value_to_string(uint64_t f, uint64_t v)
+static std::string_view value_to_string(std::span<char, 72> out, uint64_t f,
+                                        uint64_t v)
 {
     switch (f & (hex | bin | dec).value)
     {
-        // For binary, use bitset<>::to_string.
+        // For binary, write out the requested number of bits.
         // Treat values without a field-length format flag as 64 bit.
         case bin.value:
         {
+            size_t bits = 64;
             switch (f & (field8 | field16 | field32 | field64).value)
             {
                 case field8.value:
                 {
-                    return "0b" + std::bitset<8>(v).to_string();
+                    bits = 8;
+                    break;
                 }
                 case field16.value:
                 {
-                    return "0b" + std::bitset<16>(v).to_string();
+                    bits = 16;
+                    break;
                 }
                 case field32.value:
                 {
-                    return "0b" + std::bitset<32>(v).to_string();
-                }
-                case field64.value:
-                default:
-                {
-                    return "0b" + std::bitset<64>(v).to_string();
+                    bits = 32;
+                    break;
                 }
             }
+
+            out[0] = '0';
+            out[1] = 'b';
+            for (size_t i = 0; i < bits; ++i)
+            {
+                out[2 + i] = (v & (1ULL << (bits - 1 - i))) ? '1' : '0';
+            }
+            return {out.data(), bits + 2};
         }
 
         // For hex, use the appropriate sprintf.
         case hex.value:
         {
-            char value[19];
             const char* format = nullptr;
 
             switch (f & (field8 | field16 | field32 | field64).value)
@@ -88,55 +208,64 @@ static std::string value_to_string(uint64_t f, uint64_t v)
                 }
             }
 
-            snprintf(value, sizeof(value), format, v);
-            return value;
+            auto len = snprintf(out.data(), out.size(), format, v);
+            return {out.data(), static_cast<size_t>(len)};
         }
 
-        // For dec, use the simple to_string.
+        // For dec, use the simple to_chars.
         case dec.value:
         default:
         {
-            return std::to_string(v);
+            auto r = std::to_chars(out.data(), out.data() + out.size(), v);
+            return {out.data(), r.ptr};
         }
     }
 }
 
 /** Convert signed to string using format flags. */
-static std::string value_to_string(uint64_t f, int64_t v)
+static std::string_view value_to_string(std::span<char, 72> out, uint64_t f,
+                                        int64_t v)
 {
     // If hex or bin was requested just use the unsigned formatting
     // rules. (What should a negative binary number look like otherwise?)
     if (f & (hex | bin).value)
     {
-        return value_to_string(f, static_cast<uint64_t>(v));
+        return value_to_string(out, f, static_cast<uint64_t>(v));
     }
-    return std::to_string(v);
+    auto r = std::to_chars(out.data(), out.data() + out.size(), v);
+    return {out.data(), r.ptr};
 }
 
 /** Convert float to string using format flags. */
-static std::string value_to_string(uint64_t, double v)
+static std::string_view value_to_string(std::span<char, 72> out, uint64_t,
+                                        double v, std::string& large)
 {
-    // No format flags supported for floats.
-    return std::to_string(v);
+    // No format flags supported for floats.  Use the same format as
+    // std::to_string, which needs more room than 'out' for huge values.
+    auto len = snprintf(out.data(), out.size(), "%f", v);
+    if (static_cast<size_t>(len) >= out.size())
+    {
+        large = std::to_string(v);
+        return large;
+    }
+    return {out.data(), static_cast<size_t>(len)};
 }
 
-// Positions of various strings in an iovec.
+// Position of the message in the iovec, which is followed by the
+// LOG2_FMTMSG, PRIORITY, CODE_FILE, CODE_LINE, and CODE_FUNC fields.
 static constexpr size_t pos_msg = 0;
-static constexpr size_t pos_fmtmsg = 1;
-static constexpr size_t pos_prio = 2;
-static constexpr size_t pos_file = 3;
-static constexpr size_t pos_line = 4;
-static constexpr size_t pos_func = 5;
-static constexpr size_t static_locs = pos_func + 1;
+static constexpr size_t static_locs = 6;
+
+// Number of header fields that fit without a heap allocation.
+static constexpr size_t inline_headers = 24;
 
 /** No-op output of a message. */
 static void noop_extra_output(level, const std::source_location&,
-                              const std::string&)
+                              std::string_view)
 {}
 
-/** std::cerr output of a message. */
-static void cerr_extra_output(level l, const std::source_location& s,
-                              const std::string& m)
+/** The maximum level written to stderr, from "LG2_LOG_LEVEL". */
+static int stderr_max_level()
 {
     static const int maxLogLevel = []() {
         const char* logLevel = getenv("LG2_LOG_LEVEL");
@@ -157,7 +286,14 @@ static void cerr_extra_output(level l, const std::source_location& s,
         }
     }();
 
-    if (std::to_underlying(l) > maxLogLevel)
+    return maxLogLevel;
+}
+
+/** std::cerr output of a message. */
+static void cerr_extra_output(level l, const std::source_location& s,
+                              std::string_view m)
+{
+    if (std::to_underlying(l) > stderr_max_level())
     {
         return;
     }
@@ -243,25 +379,528 @@ static auto extra_output_method =
 // per systemd.exec manpage.
 static auto send_debug_to_journal = nullptr != getenv("DEBUG_INVOCATION");
 
+// Starts with every level enabled, in case something logs before the
+// static initialization below.
+std::atomic<uint8_t> enabled_levels = 0xff;
+
+/** The maximum level set by lg2::set_level(). */
+static std::atomic<int> max_level = std::to_underlying(level::debug);
+
+/** Recalculate which levels produce any output. */
+static void update_enabled_levels()
+{
+    uint8_t levels = 0;
+    for (int l = std::to_underlying(level::emergency);
+         l <= std::to_underlying(level::debug); ++l)
+    {
+        bool journal = send_debug_to_journal || (l != LOG_DEBUG);
+        bool console = (extra_output_method == cerr_extra_output) &&
+                       (l <= stderr_max_level());
+        if ((l <= max_level) && (journal || console))
+        {
+            levels |= 1 << l;
+        }
+    }
+    enabled_levels = levels;
+}
+
+[[maybe_unused]] static const bool levels_initialized = []() {
+    update_enabled_levels();
+    return true;
+}();
+
+/** Bounded multi-producer, single-consumer queue of journal entries that
+ *  are sent by a separate writer thread.
+ *
+ *  Each slot holds one entry, encoded as its fields' lengths followed by
+ *  the field data.  The slots use sequence numbers so that pushing is
+ *  lock-free (see Vyukov's bounded MPMC queue).
+ */
+class async_writer
+{
+  public:
+    /** Create the writer and start its thread. */
+    explicit async_writer(size_t count) :
+        slots(std::make_unique<slot[]>(count)), count(count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        thread = std::thread([this]() { run(); });
+    }
+
+    /** Check if an entry is small enough to fit in a queue slot. */
+    static bool fits(const iovec* iov, size_t n)
+    {
+        if (n > max_fields)
+        {
+            return false;
+        }
+
+        size_t size = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            size += iov[i].iov_len;
+        }
+        return size <= data_size;
+    }
+
+    /** Queue an entry to send.  The entry must fit in a slot.
+     *
+     *  @return false if the queue is full, in which case the caller must
+     *          decide what to do with it.
+     */
+    bool push(const iovec* iov, size_t n)
+    {
+        auto pos = tail.load(std::memory_order_relaxed);
+        slot* s = nullptr;
+        while (true)
+        {
+            s = &slots[pos % count];
+            auto seq = s->sequence.load(std::memory_order_acquire);
+            auto diff =
+                static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (tail.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        s->fields = n;
+        char* data = s->data.data();
+        for (size_t i = 0; i < n; ++i)
+        {
+            s->lengths[i] = iov[i].iov_len;
+            std::memcpy(data, iov[i].iov_base, iov[i].iov_len);
+            data += iov[i].iov_len;
+        }
+        s->sequence.store(pos + 1, std::memory_order_release);
+
+        pending.fetch_add(1, std::memory_order_release);
+        pending.notify_one();
+        return true;
+    }
+
+    /** Count an entry that was dropped because the queue was full. */
+    void dropped()
+    {
+        drops.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /** Send everything that is queued and stop the writer thread. */
+    void stop()
+    {
+        stopping.store(true);
+        pending.fetch_add(1, std::memory_order_release);
+        pending.notify_one();
+        thread.join();
+    }
+
+  private:
+    static constexpr size_t max_fields = 32;
+    static constexpr size_t data_size = 2048;
+
+    struct slot
+    {
+        std::atomic<size_t> sequence;
+        size_t fields;
+        std::array<size_t, max_fields> lengths;
+        std::array<char, data_size> data;
+    };
+
+    /** Writer thread: send entries until stopped and the queue is empty. */
+    void run()
+    {
+        while (true)
+        {
+            auto seen = pending.load(std::memory_order_acquire);
+
+            while (pop())
+            {}
+
+            if (stopping.load())
+            {
+                // Anything pushed before stop() was called is visible now.
+                while (pop())
+                {}
+                return;
+            }
+
+            pending.wait(seen, std::memory_order_acquire);
+        }
+    }
+
+    /** Send the oldest queued entry, if there is one. */
+    bool pop()
+    {
+        auto& s = slots[head % count];
+        if (s.sequence.load(std::memory_order_acquire) != head + 1)
+        {
+            return false;
+        }
+
+        std::array<iovec, max_fields + 1> iov;
+        char* data = s.data.data();
+        for (size_t i = 0; i < s.fields; ++i)
+        {
+            iov[i] = iovec{data, s.lengths[i]};
+            data += s.lengths[i];
+        }
+        size_t n = s.fields;
+
+        // Report any entries that were dropped since the last one sent.
+        std::array<char, 32> drop_field;
+        if (auto d = drops.exchange(0, std::memory_order_relaxed); d != 0)
+        {
+            auto len = snprintf(drop_field.data(), drop_field.size(),
+                                "LOG2_DROPPED=%zu", d);
+            iov[n++] = iovec{drop_field.data(), static_cast<size_t>(len)};
+        }
+
+        sd_journal_sendv(iov.data(), n);
+
+        s.sequence.store(head + count, std::memory_order_release);
+        ++head;
+        return true;
+    }
+
+    std::unique_ptr<slot[]> slots;
+    size_t count;
+    std::atomic<size_t> tail = 0;
+    size_t head = 0;
+    std::atomic<uint32_t> pending = 0;
+    std::atomic<size_t> drops = 0;
+    std::atomic<bool> stopping = false;
+    std::thread thread;
+};
+
+/** The async writer, if it is enabled by setting "LG2_ASYNC" to the number
+ *  of entries to queue.  Set to null once it is stopped. */
+static std::atomic<async_writer*> async_writer_ptr = nullptr;
+
+/** Start the async writer, if it is enabled, on the first log. */
+static async_writer* get_async_writer()
+{
+    static bool started = []() {
+        const char* entries = getenv("LG2_ASYNC");
+        if (entries == nullptr)
+        {
+            return false;
+        }
+
+        size_t count = std::clamp(strtoul(entries, nullptr, 0), 16UL, 65536UL);
+
+        // The writer is never deleted, so that it can't go away under a
+        // thread that is still logging while the process exits.
+        async_writer_ptr = new async_writer(count);
+
+        // Send the remaining entries on a normal exit.
+        std::atexit([]() {
+            if (auto* writer = async_writer_ptr.exchange(nullptr))
+            {
+                writer->stop();
+            }
+        });
+
+        // The writer thread doesn't exist in a forked child.
+        pthread_atfork(nullptr, nullptr, []() { async_writer_ptr = nullptr; });
+
+        return true;
+    }();
+
+    return started ? async_writer_ptr.load() : nullptr;
+}
+
+/** Send an entry to the journal, or queue it for the async writer.
+ *
+ *  Entries at error level and above are always sent directly, so that they
+ *  can't be lost by a full queue or a crash.  So are entries too large for
+ *  a queue slot.
+ */
+static void journal_send(level l, const iovec* iov, size_t n)
+{
+    if ((l > level::error) && async_writer::fits(iov, n))
+    {
+        if (auto* writer = get_async_writer(); writer != nullptr)
+        {
+            if (!writer->push(iov, n))
+            {
+                writer->dropped();
+            }
+            return;
+        }
+    }
+
+    sd_journal_sendv(iov, n);
+}
+
+/** Per-callsite rate limiting, enabled by setting "LG2_RATE_LIMIT" to
+ *  "<count>[/<seconds>]".
+ *
+ *  Each callsite may log 'count' entries per window of 'seconds' (default
+ *  1).  The callsites are kept in a fixed-size, open-addressed table that
+ *  is updated with atomics only, so checking a callsite never blocks.
+ */
+class rate_limiter
+{
+  public:
+    rate_limiter(uint32_t count, double seconds) :
+        count(count),
+        window_ns(std::max<int64_t>(static_cast<int64_t>(seconds * 1e9), 1))
+    {}
+
+    /** Check if a callsite may log.
+     *
+     *  @param[in] s - The callsite.
+     *  @param[out] suppressed - The number of entries suppressed in the
+     *                           callsite's previous window, to report.
+     *
+     *  @return false if this entry should be suppressed.
+     */
+    bool allow(const std::source_location& s, uint32_t& suppressed)
+    {
+        suppressed = 0;
+
+        auto* site = find(s);
+        if (site == nullptr)
+        {
+            // The table is full, so this callsite isn't limited.
+            return true;
+        }
+
+        auto now = std::chrono::steady_clock::now().time_since_epoch();
+        uint64_t current =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now)
+                .count() /
+            window_ns;
+
+        // The first entry in a new window starts the count over and
+        // reports what the last window suppressed.
+        auto window = site->window.load(std::memory_order_relaxed);
+        if ((window != current) &&
+            site->window.compare_exchange_strong(window, current,
+                                                 std::memory_order_relaxed))
+        {
+            site->logged.store(0, std::memory_order_relaxed);
+            suppressed =
+                site->suppressed.exchange(0, std::memory_order_relaxed);
+        }
+
+        if (site->logged.fetch_add(1, std::memory_order_relaxed) < count)
+        {
+            return true;
+        }
+
+        site->suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+  private:
+    static constexpr size_t table_size = 1024;
+    static constexpr size_t max_probes = 16;
+
+    struct callsite
+    {
+        std::atomic<const char*> file;
+        std::atomic<uint64_t> position;
+        std::atomic<uint64_t> window;
+        std::atomic<uint32_t> logged;
+        std::atomic<uint32_t> suppressed;
+    };
+
+    /** Find, or claim, the table entry for a callsite.
+     *
+     *  The file name is a string literal, so its address along with the
+     *  line and column identify the callsite.  An entry is claimed by
+     *  setting its file, after which the claimer sets its position, so a
+     *  null file means unused and a zero position means being claimed.
+     */
+    callsite* find(const std::source_location& s)
+    {
+        const char* file = s.file_name();
+        uint64_t position =
+            ((static_cast<uint64_t>(s.line()) << 32) | s.column()) + 1;
+
+        auto hash = std::hash<const char*>{}(file) ^
+                    (std::hash<uint64_t>{}(position) * 31);
+        for (size_t i = 0; i < max_probes; ++i)
+        {
+            auto& site = table[(hash + i) % table_size];
+            const char* expected = site.file.load(std::memory_order_acquire);
+            if ((expected == nullptr) &&
+                site.file.compare_exchange_strong(expected, file,
+                                                  std::memory_order_acq_rel))
+            {
+                site.position.store(position, std::memory_order_release);
+                return &site;
+            }
+
+            if (expected != file)
+            {
+                continue;
+            }
+
+            // Another thread claimed it for this file, so wait for it to
+            // say which callsite, which it is about to do.
+            uint64_t claimed = 0;
+            while ((claimed = site.position.load(std::memory_order_acquire)) ==
+                   0)
+            {
+                std::this_thread::yield();
+            }
+
+            if (claimed == position)
+            {
+                return &site;
+            }
+        }
+
+        return nullptr;
+    }
+
+    uint32_t count;
+    uint64_t window_ns;
+    std::array<callsite, table_size> table{};
+};
+
+/** Get the rate limiter, if it is enabled. */
+static rate_limiter* get_rate_limiter()
+{
+    // The limiter is never deleted, so that it can't go away under a
+    // thread that is still logging while the process exits.
+    static rate_limiter* limiter = []() -> rate_limiter* {
+        const char* setting = getenv("LG2_RATE_LIMIT");
+        if (setting == nullptr)
+        {
+            return nullptr;
+        }
+
+        char* end = nullptr;
+        auto count = strtoul(setting, &end, 10);
+        double seconds = 1;
+        if (*end == '/')
+        {
+            seconds = strtod(end + 1, nullptr);
+        }
+
+        if ((count == 0) || !(seconds > 0))
+        {
+            return nullptr;
+        }
+
+        return new rate_limiter(count, seconds);
+    }();
+
+    return limiter;
+}
+
+static void send_entry(level l, const std::source_location& s, const char* m,
+                       std::va_list args);
+
+/** Variadic wrapper of send_entry() for entries generated internally. */
+static void do_log_internal(level l, const std::source_location& s,
+                            const char* m, ...)
+{
+    std::va_list args;
+    va_start(args, m);
+    send_entry(l, s, m, args);
+    va_end(args);
+}
+
 // Do_log implementation.
 void do_log(level l, const std::source_location& s, const char* m, ...)
 {
-    using namespace std::string_literals;
+    // The lg2::log templates normally check this before getting here.
+    if (!level_enabled(l))
+    {
+        return;
+    }
+
+    if (auto* limiter = get_rate_limiter(); limiter != nullptr)
+    {
+        uint32_t suppressed = 0;
+        auto allowed = limiter->allow(s, suppressed);
 
-    std::vector<std::string> strings{static_locs};
+        if (suppressed != 0)
+        {
+            do_log_internal(l, s,
+                            "{SUPPRESSED_COUNT} entries from this location "
+                            "were suppressed by rate limiting",
+                            "SUPPRESSED_COUNT", (dec | unsigned_val).value,
+                            static_cast<uint64_t>(suppressed), nullptr);
+        }
+
+        if (!allowed)
+        {
+            return;
+        }
+    }
+
+    std::va_list args;
+    va_start(args, m);
+    send_entry(l, s, m, args);
+    va_end(args);
+}
 
-    std::string message{m};
+/** Format an entry and send it.
+ *
+ *  The fields are formatted into a fixed buffer on the stack and the
+ *  message placeholders are substituted in a single pass, so that the
+ *  common case doesn't touch the heap.
+ */
+static void send_entry(level l, const std::source_location& s, const char* m,
+                       std::va_list args)
+{
+    // A header field, and where its value is in the field.
+    struct header_field
+    {
+        std::string_view header;
+        std::string_view value;
+        bool substituted;
+    };
+
+    field_buffer fields;
+    small_vector<iovec, static_locs + inline_headers> iov;
+    small_vector<header_field, inline_headers> headers;
+    std::array<char, 72> number;
+
+    auto add_field = [&](std::string_view name, std::string_view value) {
+        fields.begin();
+        fields.append(name);
+        fields.append(value);
+        auto field = fields.end();
+        iov.push_back(iovec{const_cast<char*>(field.data()), field.size()});
+    };
+
+    // Reserve the message's spot; it is filled in once the headers are known.
+    iov.push_back({});
 
     // Assign all the static fields.
-    strings[pos_fmtmsg] = "LOG2_FMTMSG="s + m;
-    strings[pos_prio] = "PRIORITY="s + std::to_string(static_cast<uint64_t>(l));
-    strings[pos_file] = "CODE_FILE="s + s.file_name();
-    strings[pos_line] = "CODE_LINE="s + std::to_string(s.line());
-    strings[pos_func] = "CODE_FUNC="s + s.function_name();
+    add_field("LOG2_FMTMSG=", m);
+    auto prio = std::to_chars(number.data(), number.data() + number.size(),
+                              static_cast<uint64_t>(l));
+    add_field("PRIORITY=", {number.data(), prio.ptr});
+    add_field("CODE_FILE=", s.file_name());
+    auto line = std::to_chars(number.data(), number.data() + number.size(),
+                              s.line());
+    add_field("CODE_LINE=", {number.data(), line.ptr});
+    add_field("CODE_FUNC=", s.function_name());
 
     // Handle all the va_list args.
-    std::va_list args;
-    va_start(args, m);
     while (true)
     {
         // Get the header out.
@@ -270,26 +909,27 @@ void do_log(level l, const std::source_location& s, const char* m, ...)
         {
             break;
         }
-        std::string h{h_ptr};
+        std::string_view h{h_ptr};
 
         // Get the format flag.
         auto f = va_arg(args, uint64_t);
 
         // Handle the value depending on which type format flag it has.
-        std::string value = {};
+        std::string_view value = {};
+        std::string large;
         switch (f & (signed_val | unsigned_val | str | floating).value)
         {
             case signed_val.value:
             {
                 auto v = va_arg(args, int64_t);
-                value = value_to_string(f, v);
+                value = value_to_string(number, f, v);
                 break;
             }
 
             case unsigned_val.value:
             {
                 auto v = va_arg(args, uint64_t);
-                value = value_to_string(f, v);
+                value = value_to_string(number, f, v);
                 break;
             }
 
@@ -302,38 +942,78 @@ void do_log(level l, const std::source_location& s, const char* m, ...)
             case floating.value:
             {
                 auto v = va_arg(args, double);
-                value = value_to_string(f, v);
+                value = value_to_string(number, f, v, large);
                 break;
             }
         }
 
         // Create the field for this value.
-        strings.emplace_back(h + '=' + value);
+        fields.begin();
+        fields.append(h);
+        fields.append("=");
+        fields.append(value);
+        auto field = fields.end();
+        iov.push_back(iovec{const_cast<char*>(field.data()), field.size()});
+
+        headers.push_back({h, field.substr(h.size() + 1), false});
+    }
 
-        // Check for {HEADER} in the message and replace with value.
-        auto h_brace = '{' + h + '}';
-        if (auto start = message.find(h_brace); start != std::string::npos)
+    // Replace the first {HEADER} in the message for each header with its
+    // value.
+    fields.begin();
+    fields.append("MESSAGE=");
+    std::string_view format{m};
+    while (!format.empty())
+    {
+        auto open = format.find('{');
+        auto close = format.find('}', open);
+        if (close == std::string_view::npos)
         {
-            message.replace(start, h_brace.size(), value);
+            fields.append(format);
+            break;
         }
-    }
-    va_end(args);
 
-    // Add the final message into the strings array.
-    strings[pos_msg] = "MESSAGE="s + message.data();
+        fields.append(format.substr(0, open));
 
-    // Transform strings -> iovec.
-    std::vector<iovec> iov{};
-    std::ranges::transform(strings, std::back_inserter(iov), [](auto& s) {
-        return iovec{s.data(), s.length()};
-    });
+        auto name = format.substr(open + 1, close - open - 1);
+        auto end = headers.data() + headers.size();
+        auto header =
+            std::ranges::find_if(headers.data(), end, [name](const auto& h) {
+                return !h.substituted && h.header == name;
+            });
+        if (header != end)
+        {
+            header->substituted = true;
+            fields.append(header->value);
+            format.remove_prefix(close + 1);
+        }
+        else
+        {
+            fields.append("{");
+            format.remove_prefix(open + 1);
+        }
+    }
+    auto field = fields.end();
+    iov[pos_msg] = iovec{const_cast<char*>(field.data()), field.size()};
+    auto message = field.substr(std::string_view{"MESSAGE="}.size());
 
     // Output the iovec.
     if (send_debug_to_journal || l != level::debug)
     {
-        sd_journal_sendv(iov.data(), strings.size());
+        journal_send(l, iov.data(), iov.size());
     }
     extra_output_method(l, s, message);
 }
 
 } // namespace lg2::details
+
+namespace lg2
+{
+
+void set_level(level l)
+{
+    details::max_level = std::to_underlying(l);
+    details::update_enabled_levels();
+}
+
+} // namespace lg2
@@ -11,6 +11,7 @@
 #include "paths.hpp"
 #include "util.hpp"
 
+#include <fcntl.h>
 #include <systemd/sd-bus.h>
 #include <systemd/sd-journal.h>
 #include <unistd.h>
@@ -19,6 +20,8 @@
 #include <sdbusplus/vtable.hpp>
 #include <xyz/openbmc_project/State/Host/server.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <cstdio>
@@ -28,7 +31,7 @@
 #include <ranges>
 #include <set>
 #include <string>
-#include <string_view>
+#include <thread>
 #include <vector>
 
 using namespace std::chrono;
@@ -43,6 +46,41 @@ namespace logging
 {
 namespace internal
 {
+namespace
+{
+
+constexpr auto settingsService = "xyz.openbmc_project.Settings";
+constexpr auto logSettingsPath = "/xyz/openbmc_project/logging/settings";
+constexpr auto logSettingsIface = "xyz.openbmc_project.Logging.Settings";
+constexpr auto quiesceOnHwErrorProp = "QuiesceOnHwError";
+
+/** @brief The name prefix an error directory is renamed to when all of
+ *         its files are being removed.
+ */
+std::string deletedDirPrefix(const fs::path& dir)
+{
+    return '.' + dir.filename().string() + ".deleted-";
+}
+
+/** @brief Recursively remove directories on a detached thread. */
+void removeInBackground(std::vector<fs::path> dirs)
+{
+    if (dirs.empty())
+    {
+        return;
+    }
+
+    std::thread([dirs = std::move(dirs)]() {
+        for (const auto& dir : dirs)
+        {
+            std::error_code ec;
+            fs::remove_all(dir, ec);
+        }
+    }).detach();
+}
+
+} // namespace
+
 inline auto getLevel(const std::string& errMsg)
 {
     auto reqLevel = Entry::Level::Error; // Default to Error
@@ -58,6 +96,8 @@ inline auto getLevel(const std::string& errMsg)
 
 Manager::~Manager()
 {
+    flushPendingCreates();
+
     if constexpr (REDUNDANT_BMC)
     {
         if (errDirInotifyFD != -1)
@@ -106,26 +146,9 @@ void Manager::_commit(uint64_t transactionId [[maybe_unused]],
     // operations.  Just skip over them.
     if (!IS_UNIT_TEST)
     {
-        static constexpr auto transactionIdVar =
-            std::string_view{"TRANSACTION_ID"};
-        // Length of 'TRANSACTION_ID' string.
-        static constexpr auto transactionIdVarSize = transactionIdVar.size();
-        // Length of 'TRANSACTION_ID=' string.
-        static constexpr auto transactionIdVarOffset = transactionIdVarSize + 1;
-
         // Flush all the pending log messages into the journal
         util::journalSync();
 
-        sd_journal* j = nullptr;
-        int rc = sd_journal_open(&j, SD_JOURNAL_LOCAL_ONLY);
-        if (rc < 0)
-        {
-            lg2::error("Failed to open journal: {ERROR}", "ERROR",
-                       strerror(-rc));
-            return;
-        }
-
-        std::string transactionIdStr = std::to_string(transactionId);
         std::set<std::string> metalist;
         auto metamap = g_errMetaMap.find(errMsg);
         if (metamap != g_errMetaMap.end())
@@ -136,71 +159,13 @@ void Manager::_commit(uint64_t transactionId [[maybe_unused]],
         // Add _PID field information in AdditionalData.
         metalist.insert("_PID");
 
-        // Read the journal from the end to get the most recent entry first.
-        // The result from the sd_journal_get_data() is of the form
-        // VARIABLE=value.
-        SD_JOURNAL_FOREACH_BACKWARDS(j)
+        auto data = util::readTransactionData(transactionId, metalist);
+        if (!data)
         {
-            const char* data = nullptr;
-            size_t length = 0;
-
-            // Look for the transaction id metadata variable
-            rc = sd_journal_get_data(j, transactionIdVar.data(),
-                                     (const void**)&data, &length);
-            if (rc < 0)
-            {
-                // This journal entry does not have the TRANSACTION_ID
-                // metadata variable.
-                continue;
-            }
-
-            // journald does not guarantee that sd_journal_get_data() returns
-            // NULL terminated strings, so need to specify the size to use to
-            // compare, use the returned length instead of anything that relies
-            // on NULL terminators like strlen(). The data variable is in the
-            // form of 'TRANSACTION_ID=1234'. Remove the TRANSACTION_ID
-            // characters plus the (=) sign to do the comparison. 'data +
-            // transactionIdVarOffset' will be in the form of '1234'. 'length -
-            // transactionIdVarOffset' will be the length of '1234'.
-            if ((length <= (transactionIdVarOffset)) ||
-                (transactionIdStr.compare(
-                     0, transactionIdStr.size(), data + transactionIdVarOffset,
-                     length - transactionIdVarOffset) != 0))
-            {
-                // The value of the TRANSACTION_ID metadata is not the requested
-                // transaction id number.
-                continue;
-            }
-
-            // Search for all metadata variables in the current journal entry.
-            for (auto i = metalist.cbegin(); i != metalist.cend();)
-            {
-                rc = sd_journal_get_data(j, (*i).c_str(), (const void**)&data,
-                                         &length);
-                if (rc < 0)
-                {
-                    // Metadata variable not found, check next metadata
-                    // variable.
-                    i++;
-                    continue;
-                }
-
-                // Metadata variable found, save it and remove it from the set.
-                std::string metadata(data, length);
-                if (auto pos = metadata.find('='); pos != std::string::npos)
-                {
-                    auto key = metadata.substr(0, pos);
-                    auto value = metadata.substr(pos + 1);
-                    additionalData.emplace(std::move(key), std::move(value));
-                }
-                i = metalist.erase(i);
-            }
-            if (metalist.empty())
-            {
-                // All metadata variables found, break out of journal loop.
-                break;
-            }
+            return;
         }
+        additionalData = std::move(*data);
+
         if (!metalist.empty())
         {
             // Not all the metadata variables were found in the journal.
@@ -210,8 +175,6 @@ void Manager::_commit(uint64_t transactionId [[maybe_unused]],
                           metaVarStr);
             }
         }
-
-        sd_journal_close(j);
     }
     createEntry(errMsg, errLvl, additionalData);
 }
@@ -238,6 +201,89 @@ auto Manager::createEntry(std::string errMsg, Entry::Level errLvl,
         }
     }
 
+    auto& entry =
+        addEntry(std::move(errMsg), errLvl, std::move(additionalData));
+
+    serialize(entry);
+
+    entryCreated(entry, ffdc);
+
+    // Note: No need to close the file descriptors in the FFDC.
+
+    return std::string(OBJ_ENTRY) + '/' + std::to_string(entry.id());
+}
+
+auto Manager::createBatch(BatchEntries batch)
+    -> std::vector<sdbusplus::object_path>
+{
+    std::vector<sdbusplus::object_path> objPaths;
+    std::vector<const Entry*> created;
+    objPaths.reserve(batch.size());
+    created.reserve(batch.size());
+
+    // Apply the caps once for the whole batch, before adding it, so that
+    // none of its entries are created and then removed again.
+    if (!Extensions::disableDefaultLogCaps())
+    {
+        auto numErrors = static_cast<size_t>(
+            std::ranges::count_if(batch, [](const auto& batchEntry) {
+                return std::get<Severity>(batchEntry) < Entry::sevLowerLimit;
+            }));
+
+        // A batch that doesn't fit by itself would leave the list over
+        // its cap for good.
+        if ((numErrors > ERROR_CAP) ||
+            (batch.size() - numErrors > ERROR_INFO_CAP))
+        {
+            lg2::error("CreateBatch of {NUM} entries is over the error caps",
+                       "NUM", batch.size());
+            throw sdbusplus::xyz::openbmc_project::Common::Error::
+                InvalidArgument();
+        }
+
+        std::set<uint32_t> ids;
+        auto prune = [this, &ids](const std::list<uint32_t>& list,
+                                  size_t cap, size_t adding) {
+            auto room = cap - std::min(cap, adding);
+            auto excess = (list.size() > room) ? list.size() - room : 0;
+            for (auto it = list.begin(); (excess > 0) && (it != list.end());
+                 ++it)
+            {
+                if (!isDeleteProhibited(*it))
+                {
+                    ids.insert(*it);
+                    excess--;
+                }
+            }
+        };
+
+        prune(realErrors, ERROR_CAP, numErrors);
+        prune(infoErrors, ERROR_INFO_CAP, batch.size() - numErrors);
+        eraseEntries(ids);
+    }
+
+    for (auto& [message, severity, additionalData] : batch)
+    {
+        auto& entry = addEntry(std::move(message), severity,
+                               std::move(additionalData));
+        created.push_back(&entry);
+        objPaths.emplace_back(std::string(OBJ_ENTRY) + '/' +
+                              std::to_string(entry.id()));
+    }
+
+    serialize(created);
+
+    for (const auto* entry : created)
+    {
+        entryCreated(*entry, FFDCEntries{});
+    }
+
+    return objPaths;
+}
+
+Entry& Manager::addEntry(std::string errMsg, Entry::Level errLvl,
+                         std::map<std::string, std::string> additionalData)
+{
     if constexpr (REDUNDANT_BMC)
     {
         if (!bmcPosMgr->isPositionValid())
@@ -287,23 +333,21 @@ auto Manager::createEntry(std::string errMsg, Entry::Level errLvl,
         errLvl, std::move(errMsg), std::move(additionalData),
         std::move(objects), fwVersion, getEntrySerializePath(entryId), *this);
 
-    serialize(*e);
-    serializeJSON(*e);
+    // Add entry before calling the extensions so that they have access to it
+    auto it = entries.insert(std::make_pair(entryId, std::move(e))).first;
+    indexEntry(*it->second);
+    return *it->second;
+}
 
-    if (isQuiesceOnErrorEnabled() && (errLvl < Entry::sevLowerLimit) &&
-        isCalloutPresent(*e))
+void Manager::entryCreated(const Entry& entry, const FFDCEntries& ffdc)
+{
+    if (isQuiesceOnErrorEnabled() &&
+        (entry.severity() < Entry::sevLowerLimit) && isCalloutPresent(entry))
     {
-        quiesceOnError(entryId);
+        quiesceOnError(entry.id());
     }
 
-    // Add entry before calling the extensions so that they have access to it
-    entries.insert(std::make_pair(entryId, std::move(e)));
-
-    doExtensionLogCreate(*entries.find(entryId)->second, ffdc);
-
-    // Note: No need to close the file descriptors in the FFDC.
-
-    return objPath;
+    queueExtensionLogCreate(entry, ffdc);
 }
 
 auto Manager::createFromEvent(
@@ -323,13 +367,23 @@ bool Manager::isQuiesceOnErrorEnabled()
         return false;
     }
 
+    if (quiesceSettingMatches.empty())
+    {
+        watchQuiesceOnErrorSetting();
+    }
+
+    if (quiesceOnHwError)
+    {
+        return *quiesceOnHwError;
+    }
+
     std::variant<bool> property;
 
     auto method = this->busLog.new_method_call(
-        "xyz.openbmc_project.Settings", "/xyz/openbmc_project/logging/settings",
-        "org.freedesktop.DBus.Properties", "Get");
+        settingsService, logSettingsPath, "org.freedesktop.DBus.Properties",
+        "Get");
 
-    method.append("xyz.openbmc_project.Logging.Settings", "QuiesceOnHwError");
+    method.append(logSettingsIface, quiesceOnHwErrorProp);
 
     try
     {
@@ -343,7 +397,68 @@ bool Manager::isQuiesceOnErrorEnabled()
         return false;
     }
 
-    return std::get<bool>(property);
+    quiesceOnHwError = std::get<bool>(property);
+    return *quiesceOnHwError;
+}
+
+void Manager::watchQuiesceOnErrorSetting()
+{
+    using namespace sdbusplus::match_rules;
+
+    quiesceSettingMatches.emplace_back(
+        busLog, propertiesChanged(logSettingsPath, logSettingsIface),
+        [this](sdbusplus::message_t& msg) {
+            try
+            {
+                std::string interface;
+                std::map<std::string, std::variant<bool>> properties;
+                msg.read(interface, properties);
+
+                auto it = properties.find(quiesceOnHwErrorProp);
+                if (it != properties.end())
+                {
+                    quiesceOnHwError = std::get<bool>(it->second);
+                }
+            }
+            catch (const std::exception& e)
+            {
+                // Read it again the next time it's needed.
+                quiesceOnHwError.reset();
+            }
+        });
+
+    quiesceSettingMatches.emplace_back(
+        busLog, interfacesAdded() + argNpath(0, logSettingsPath),
+        [this](sdbusplus::message_t& msg) {
+            try
+            {
+                sdbusplus::object_path path;
+                std::map<std::string,
+                         std::map<std::string, std::variant<bool>>>
+                    interfaces;
+                msg.read(path, interfaces);
+
+                auto iface = interfaces.find(logSettingsIface);
+                if (iface != interfaces.end())
+                {
+                    auto it = iface->second.find(quiesceOnHwErrorProp);
+                    if (it != iface->second.end())
+                    {
+                        quiesceOnHwError = std::get<bool>(it->second);
+                    }
+                }
+            }
+            catch (const std::exception& e)
+            {
+                quiesceOnHwError.reset();
+            }
+        });
+
+    // Changes made while the settings service is restarting aren't
+    // signaled, so forget the value when it goes away.
+    quiesceSettingMatches.emplace_back(
+        busLog, nameOwnerChanged(settingsService),
+        [this](sdbusplus::message_t&) { quiesceOnHwError.reset(); });
 }
 
 bool Manager::isCalloutPresent(const Entry& entry)
@@ -502,6 +617,116 @@ void Manager::doExtensionLogCreate(const Entry& entry, const FFDCEntries& ffdc)
     }
 }
 
+Manager::PendingCreate::PendingCreate(uint32_t id, const FFDCEntries& ffdc) :
+    id(id), queued(std::chrono::steady_clock::now())
+{
+    for (const auto& entry : ffdc)
+    {
+        int fd = fcntl(std::get<ffdcFDPos>(entry), F_DUPFD_CLOEXEC, 0);
+        if (fd == -1)
+        {
+            lg2::error("Failed to duplicate FFDC file descriptor for "
+                       "entry {ID}: {ERROR}",
+                       "ID", id, "ERROR", strerror(errno));
+            continue;
+        }
+
+        this->ffdc.emplace_back(std::get<ffdcFormatPos>(entry),
+                                std::get<ffdcSubtypePos>(entry),
+                                std::get<ffdcVersionPos>(entry), fd);
+    }
+}
+
+Manager::PendingCreate::~PendingCreate()
+{
+    for (const auto& entry : ffdc)
+    {
+        close(std::get<ffdcFDPos>(entry));
+    }
+}
+
+void Manager::queueExtensionLogCreate(const Entry& entry,
+                                      const FFDCEntries& ffdc)
+{
+    if (Extensions::getCreateFunctions().empty())
+    {
+        return;
+    }
+
+    if (pendingCreates.size() >= maxPendingCreates)
+    {
+        if (createQueueStats.throttled++ == 0)
+        {
+            lg2::warning("The extension create queue is full, so creating "
+                         "event logs will wait for it");
+        }
+        runPendingCreate();
+    }
+
+    pendingCreates.push_back(std::make_unique<PendingCreate>(entry.id(), ffdc));
+
+    createQueueStats.queued++;
+    createQueueStats.maxDepth =
+        std::max(createQueueStats.maxDepth, pendingCreates.size());
+
+    if (!createEventSource)
+    {
+        createEventSource = std::make_unique<sdeventplus::source::Defer>(
+            event, std::bind_front(&Manager::processPendingCreates, this));
+    }
+}
+
+void Manager::runPendingCreate()
+{
+    auto pending = std::move(pendingCreates.front());
+    pendingCreates.pop_front();
+
+    auto latency = duration_cast<microseconds>(steady_clock::now() -
+                                               pending->queued);
+    createQueueStats.totalLatency += latency;
+    createQueueStats.maxLatency = std::max(createQueueStats.maxLatency,
+                                           latency);
+
+    // The entry may have been deleted while it was waiting.
+    if (auto it = entries.find(pending->id); it != entries.end())
+    {
+        doExtensionLogCreate(*it->second, pending->ffdc);
+    }
+}
+
+void Manager::processPendingCreates(
+    sdeventplus::source::EventBase& /*source*/)
+{
+    // Make as many calls as fit in the budget.  Sharing the dispatch lets
+    // the journal syncs the extensions ask for be coalesced into one.
+    auto deadline = steady_clock::now() + createDispatchBudget;
+    size_t count = 0;
+
+    while (!pendingCreates.empty() && (count++ < maxCreatesPerDispatch))
+    {
+        runPendingCreate();
+
+        if (steady_clock::now() >= deadline)
+        {
+            break;
+        }
+    }
+
+    if (pendingCreates.empty())
+    {
+        createEventSource.reset();
+    }
+}
+
+void Manager::flushPendingCreates()
+{
+    while (!pendingCreates.empty())
+    {
+        runPendingCreate();
+    }
+    createEventSource.reset();
+}
+
 void Manager::processMetadata(const std::string& /*errorName*/,
                               const std::vector<std::string>& additionalData,
                               AssociationList& objects) const
@@ -523,6 +748,75 @@ void Manager::processMetadata(const std::string& /*errorName*/,
     }
 }
 
+auto Manager::query(Severity highestSeverity, Severity lowestSeverity,
+                    uint64_t startTime, uint64_t endTime,
+                    ResolvedFilter resolved, std::string messagePrefix,
+                    uint32_t offset, uint32_t limit)
+    -> std::tuple<std::vector<QueryResult>, uint32_t>
+{
+    // Gather the candidates from the severity index, newest first.
+    std::vector<uint32_t> ids;
+    auto first = static_cast<size_t>(highestSeverity);
+    auto last = std::min(static_cast<size_t>(lowestSeverity),
+                         severityIndex.size() - 1);
+    for (auto level = first; level <= last; level++)
+    {
+        ids.insert(ids.end(), severityIndex[level].begin(),
+                   severityIndex[level].end());
+    }
+    std::ranges::sort(ids, std::greater{});
+
+    std::vector<QueryResult> results;
+    uint32_t total = 0;
+
+    for (auto id : ids)
+    {
+        auto it = entries.find(id);
+        if (it == entries.end())
+        {
+            continue;
+        }
+        const auto& entry = *it->second;
+
+        if ((entry.severity() < highestSeverity) ||
+            (entry.severity() > lowestSeverity) ||
+            (entry.timestamp() < startTime) || (entry.timestamp() > endTime) ||
+            ((resolved == ResolvedFilter::Resolved) && !entry.resolved()) ||
+            ((resolved == ResolvedFilter::Unresolved) && entry.resolved()) ||
+            !entry.message().starts_with(messagePrefix))
+        {
+            continue;
+        }
+
+        if ((total >= offset) && ((limit == 0) || (results.size() < limit)))
+        {
+            results.emplace_back(entry.id(), entry.timestamp(),
+                                 entry.severity(), entry.message(),
+                                 entry.resolved());
+        }
+        total++;
+    }
+
+    return {std::move(results), total};
+}
+
+void Manager::indexEntry(const Entry& entry)
+{
+    auto level = static_cast<size_t>(entry.severity());
+    if (level < severityIndex.size())
+    {
+        severityIndex[level].insert(entry.id());
+    }
+}
+
+void Manager::unindexEntry(uint32_t id)
+{
+    for (auto& ids : severityIndex)
+    {
+        ids.erase(id);
+    }
+}
+
 void Manager::checkAndRemoveBlockingError(uint32_t entryId)
 {
     // First look for blocking object and remove
@@ -561,119 +855,122 @@ size_t Manager::eraseAll()
                        "ERROR", e);
         }
     }
-    size_t entriesSize = entries.size();
-    auto iter = entries.begin();
-    if (logIDWithHwIsolation.empty())
+
+    std::set<uint32_t> hwIsolated{logIDWithHwIsolation.begin(),
+                                  logIDWithHwIsolation.end()};
+    std::set<uint32_t> ids;
+
+    for (const auto& [id, entry] : entries)
     {
-        while (iter != entries.end())
+        if (!hwIsolated.contains(id) && !isDeleteProhibited(id))
         {
-            auto e = iter->first;
-            ++iter;
-            erase(e);
+            ids.insert(ids.end(), id);
         }
-        entryId = 0;
     }
-    else
+
+    eraseEntries(ids);
+
+    entryId = entries.empty() ? 0 : entries.rbegin()->first;
+
+    return ids.size();
+}
+
+void Manager::erase(uint32_t entryId)
+{
+    if (!entries.contains(entryId))
+    {
+        lg2::error("Invalid entry ID ({ID}) to delete", "ID", entryId);
+        return;
+    }
+
+    if (isDeleteProhibited(entryId))
+    {
+        throw sdbusplus::xyz::openbmc_project::Common::Error::Unavailable();
+    }
+
+    eraseEntries({entryId});
+}
+
+bool Manager::isDeleteProhibited(uint32_t entryId)
+{
+    for (auto& func : Extensions::getDeleteProhibitedFunctions())
     {
-        while (iter != entries.end())
+        try
         {
-            auto e = iter->first;
-            ++iter;
-            try
+            bool prohibited = false;
+            func(entryId, prohibited);
+            if (prohibited)
             {
-                if (!std::ranges::contains(logIDWithHwIsolation, e))
-                {
-                    erase(e);
-                }
-                else
-                {
-                    entriesSize--;
-                }
-            }
-            catch (const sdbusplus::xyz::openbmc_project::Common::Error::
-                       Unavailable& e)
-            {
-                entriesSize--;
+                return true;
             }
         }
-        if (!entries.empty())
+        catch (const sdbusplus::xyz::openbmc_project::Common::Error::
+                   Unavailable& e)
         {
-            entryId = std::ranges::max_element(entries, [](const auto& a,
-                                                           const auto& b) {
-                          return a.first < b.first;
-                      })->first;
+            return true;
         }
-        else
+        catch (const std::exception& e)
         {
-            entryId = 0;
+            lg2::error("An extension's deleteProhibited function threw an "
+                       "exception: {ERROR}",
+                       "ERROR", e);
         }
     }
-    return entriesSize;
+
+    return false;
 }
 
-void Manager::erase(uint32_t entryId)
+void Manager::eraseEntries(const std::set<uint32_t>& ids)
 {
-    auto entryFound = entries.find(entryId);
-    if (entries.end() != entryFound)
+    if (ids.empty())
     {
-        for (auto& func : Extensions::getDeleteProhibitedFunctions())
-        {
-            try
-            {
-                bool prohibited = false;
-                func(entryId, prohibited);
-                if (prohibited)
-                {
-                    throw sdbusplus::xyz::openbmc_project::Common::Error::
-                        Unavailable();
-                }
-            }
-            catch (const sdbusplus::xyz::openbmc_project::Common::Error::
-                       Unavailable& e)
-            {
-                throw;
-            }
-            catch (const std::exception& e)
-            {
-                lg2::error("An extension's deleteProhibited function threw an "
-                           "exception: {ERROR}",
-                           "ERROR", e);
-            }
-        }
+        return;
+    }
 
-        // Delete the persistent representation of this error.
-        fs::path errorPath(paths::error());
-        errorPath /= std::to_string(entryId);
-        fs::remove(errorPath);
+    auto erased = [&ids](uint32_t id) { return ids.contains(id); };
+    realErrors.remove_if(erased);
+    infoErrors.remove_if(erased);
 
-        fs::path jsonPath(paths::error_json());
-        jsonPath /= std::to_string(entryId) + ".json";
-        fs::remove(jsonPath);
+    std::erase_if(blockingErrors, [&ids](const std::unique_ptr<Block>& obj) {
+        return ids.contains(obj->entryId);
+    });
 
-        auto removeId = [](std::list<uint32_t>& ids, uint32_t id) {
-            auto it = std::find(ids.begin(), ids.end(), id);
-            if (it != ids.end())
-            {
-                ids.erase(it);
-            }
-        };
-        if (entryFound->second->severity() >= Entry::sevLowerLimit)
+    std::erase_if(pendingCreates,
+                  [&ids](const std::unique_ptr<PendingCreate>& pending) {
+                      return ids.contains(pending->id);
+                  });
+
+    for (auto id : ids)
+    {
+        unindexEntry(id);
+        entries.erase(id);
+        propChangedEntryCallback.erase(id);
+    }
+
+    // Delete the persistent representation of these errors.
+    removeEntryFiles(ids);
+
+    for (auto& remove : Extensions::getDeleteManyFunctions())
+    {
+        try
         {
-            removeId(infoErrors, entryId);
+            remove(ids);
         }
-        else
+        catch (const std::exception& e)
         {
-            removeId(realErrors, entryId);
+            lg2::error("An extension's delete function threw an exception: "
+                       "{ERROR}",
+                       "ERROR", e);
         }
-        entries.erase(entryFound);
-
-        checkAndRemoveBlockingError(entryId);
+    }
 
-        for (auto& remove : Extensions::getDeleteFunctions())
+    for (auto& remove : Extensions::getDeleteFunctions())
+    {
+        for (auto id : ids)
         {
             try
             {
-                remove(entryId);
+                remove(id);
             }
             catch (const std::exception& e)
             {
@@ -683,9 +980,68 @@ void Manager::erase(uint32_t entryId)
             }
         }
     }
-    else
+}
+
+void Manager::removeEntryFiles(const std::set<uint32_t>& ids)
+{
+    // The redundant BMC sync watches the directory itself, so it
+    // can't be swapped out from under it.
+    if (!REDUNDANT_BMC && entries.empty() && (ids.size() > 1))
     {
-        lg2::error("Invalid entry ID ({ID}) to delete", "ID", entryId);
+        auto stamp = std::to_string(
+            steady_clock::now().time_since_epoch().count());
+        std::vector<fs::path> trash;
+        bool swapped = true;
+
+        for (const auto& dir : {paths::error(), paths::error_json()})
+        {
+            auto old = dir.parent_path() /
+                       (deletedDirPrefix(dir) + stamp);
+
+            std::error_code renameEC;
+            fs::rename(dir, old, renameEC);
+            if (renameEC)
+            {
+                swapped = false;
+                break;
+            }
+
+            std::error_code createEC;
+            fs::create_directories(dir, createEC);
+            if (createEC)
+            {
+                // Don't leave the directory missing.  Put it back and
+                // remove its files one at a time below instead.
+                lg2::error("Failed to create {DIR}: {ERROR}", "DIR", dir,
+                           "ERROR", createEC.message());
+                fs::rename(old, dir, renameEC);
+                if (renameEC)
+                {
+                    lg2::error("Failed to rename {OLD} back to {DIR}: {ERROR}",
+                               "OLD", old, "DIR", dir, "ERROR",
+                               renameEC.message());
+                }
+                swapped = false;
+                break;
+            }
+
+            trash.push_back(old);
+        }
+
+        removeInBackground(std::move(trash));
+
+        // If both were swapped out, there is nothing left to remove.
+        if (swapped)
+        {
+            return;
+        }
+    }
+
+    std::error_code ec;
+    for (auto id : ids)
+    {
+        fs::remove(paths::error() / std::to_string(id), ec);
+        fs::remove(paths::error_json() / (std::to_string(id) + ".json"), ec);
     }
 }
 
@@ -698,59 +1054,144 @@ void Manager::restore()
     fs::path dir(paths::error());
     fs::path jsondir(paths::error_json());
 
+    // Finish removing any directories left behind by a previous eraseAll().
+    std::vector<fs::path> leftovers;
+    std::error_code ec;
+    for (auto& file : fs::directory_iterator(dir.parent_path(), ec))
+    {
+        auto name = file.path().filename().string();
+        if (name.starts_with(deletedDirPrefix(dir)) ||
+            name.starts_with(deletedDirPrefix(jsondir)))
+        {
+            leftovers.push_back(file.path());
+        }
+    }
+    removeInBackground(std::move(leftovers));
+
     if (!fs::exists(dir) && !fs::exists(jsondir))
     {
         return;
     }
 
+    auto restoreStart = std::chrono::steady_clock::now();
+
     // The directory location might have JSON or Cereal serialized logs (or
     // both).  Use a map to deduplicate to just the individual event IDs and
     // then deserialize them.
     std::map<uint32_t, std::filesystem::path> files{};
-    // Prioritize for JSON first.
-    for (auto& file : fs::directory_iterator(jsondir))
+    // Prioritize for Cereal first, as that is the only format kept up to
+    // date.  The JSON files are only written by older code levels.
+    if (fs::exists(dir))
     {
-        auto id = file.path().filename().string();
-        if (!id.ends_with(".json"))
+        for (auto& file : fs::directory_iterator(dir))
         {
-            continue;
-        }
+            auto id = file.path().filename().string();
 
-        uint32_t idNum = std::stoul(id.substr(0, id.size() - 5));
-        files.try_emplace(idNum, file.path());
+            // Clean up after a write that was interrupted before its
+            // temporary file could be renamed into place.
+            if (id.starts_with('.'))
+            {
+                std::error_code ec;
+                fs::remove(file.path(), ec);
+                continue;
+            }
+
+            uint32_t idNum = std::stoul(id);
+            files.try_emplace(idNum, file.path());
+        }
     }
-    // Look for Cereal.
-    for (auto& file : fs::directory_iterator(dir))
+    // Look for JSON.
+    if (fs::exists(jsondir))
     {
-        auto id = file.path().filename().string();
-        uint32_t idNum = std::stoul(id);
+        for (auto& file : fs::directory_iterator(jsondir))
+        {
+            auto id = file.path().filename().string();
+            if (!id.ends_with(".json"))
+            {
+                continue;
+            }
 
-        files.try_emplace(idNum, file.path());
+            uint32_t idNum = std::stoul(id.substr(0, id.size() - 5));
+            if (!files.try_emplace(idNum, file.path()).second)
+            {
+                // The Cereal file is the one kept up to date, so the JSON
+                // is stale.  Remove it so that an older code level, which
+                // would prefer it, can't restore old data after a
+                // downgrade.
+                fs::remove(file.path(), ec);
+            }
+        }
     }
 
+    // Decoding the files is the slow part of a restore, so spread it across
+    // worker threads.  The Entry objects are still created here as adding
+    // them to the bus isn't thread safe.
+    struct RestoreItem
+    {
+        uint32_t id;
+        fs::path path;
+        std::unique_ptr<Entry> entry;
+        bool restored = false;
+    };
+
+    std::vector<RestoreItem> items;
+    items.reserve(files.size());
     for (const auto& [idNum, filePath] : files)
     {
-        auto e = std::make_unique<Entry>(
-            busLog, std::string(OBJ_ENTRY) + '/' + std::to_string(idNum), idNum,
-            *this);
+        items.emplace_back(
+            idNum, filePath,
+            std::make_unique<Entry>(
+                busLog, std::string(OBJ_ENTRY) + '/' + std::to_string(idNum),
+                idNum, *this));
+    }
 
-        if (filePath.extension() == ".json")
+    std::atomic<size_t> next{0};
+    auto decode = [&items, &next]() {
+        for (auto i = next++; i < items.size(); i = next++)
         {
-            if (!deserializeJSON(filePath, *e))
+            auto& item = items[i];
+            try
             {
-                continue;
+                if (item.path.extension() == ".json")
+                {
+                    item.restored = deserializeJSON(item.path, *item.entry);
+                }
+                else
+                {
+                    item.restored = deserialize(item.path, *item.entry);
+                }
+            }
+            catch (const std::exception& e)
+            {
+                lg2::error("Failed restoring {PATH}: {ERROR}", "PATH",
+                           item.path, "ERROR", e);
             }
-            e->path(filePath, true);
         }
-        else
-        {
-            deserialize(filePath, *e);
+    };
+
+    // Only bother with threads when there are enough files to make it
+    // worthwhile.
+    constexpr size_t minFilesPerThread = 64;
+    auto numThreads =
+        std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1U),
+                         items.size() / minFilesPerThread);
 
-            // If we got here, either we didn't record the file in JSON
-            // previously, such as due to an upgrade, or it is corrupted.
-            // Rewrite the JSON now and ensure the path is adjusted.
-            auto jsonPath = serializeJSON(*e);
-            e->path(jsonPath, true);
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < numThreads; i++)
+    {
+        workers.emplace_back(decode);
+    }
+    decode();
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    for (auto& [idNum, filePath, e, restored] : items)
+    {
+        if (!restored)
+        {
+            continue;
         }
 
         // Sanity check for proper deserialization.
@@ -762,6 +1203,19 @@ void Manager::restore()
             continue;
         }
 
+        if (filePath.extension() == ".json")
+        {
+            // Only the JSON was found, so the Cereal file that will be kept
+            // up to date from now on needs to be written.  Leave that until
+            // the event loop is running so it doesn't delay startup.
+            pendingMigrations.push_back(idNum);
+            e->path(getEntrySerializePath(idNum), true);
+        }
+        else
+        {
+            e->path(filePath, true);
+        }
+
         // Add the event to the appropriate queue.
         if (e->severity() >= Entry::sevLowerLimit)
         {
@@ -772,9 +1226,24 @@ void Manager::restore()
             realErrors.push_back(idNum);
         }
 
+        indexEntry(*e);
         entries.insert(std::make_pair(idNum, std::move(e)));
     }
 
+    if (!pendingMigrations.empty())
+    {
+        migrationEventSource = std::make_unique<sdeventplus::source::Defer>(
+            event, std::bind_front(&Manager::migrateEntries, this));
+    }
+
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - restoreStart);
+    lg2::info("Restored {NUM_ENTRIES} event logs from {NUM_FILES} files in "
+              "{DURATION}ms using {NUM_THREADS} threads",
+              "NUM_ENTRIES", entries.size(), "NUM_FILES", files.size(),
+              "DURATION", duration.count(), "NUM_THREADS",
+              std::max<size_t>(numThreads, 1));
+
     if constexpr (!REDUNDANT_BMC)
     {
         if (!entries.empty())
@@ -797,6 +1266,26 @@ void Manager::restore()
     }
 }
 
+void Manager::migrateEntries(sdeventplus::source::EventBase& /*source*/)
+{
+    for (auto id : pendingMigrations)
+    {
+        if (auto it = entries.find(id); it != entries.end())
+        {
+            // Once the Cereal file is written the JSON one is stale.
+            if (!serialize(*it->second).empty())
+            {
+                std::error_code ec;
+                fs::remove(paths::error_json() / (std::to_string(id) + ".json"),
+                           ec);
+            }
+        }
+    }
+
+    pendingMigrations.clear();
+    migrationEventSource.reset();
+}
+
 std::string Manager::readFWVersion()
 {
     auto version = util::getOSReleaseValue("VERSION_ID");
@@ -871,7 +1360,12 @@ void Manager::errorFileChanged(sdeventplus::source::IO&, int, uint32_t revents)
     {
         auto* ev = reinterpret_cast<inotify_event*>(&buf[offset]);
 
-        if (ev->len)
+        // Skip the temporary files serialize() writes and then renames,
+        // and the renames this process did itself, which are already
+        // up to date in memory.
+        if (ev->len && (ev->name[0] != '.') &&
+            !((ev->mask & IN_MOVED_TO) &&
+              isOwnRename(paths::error() / ev->name)))
         {
             try
             {
@@ -951,6 +1445,7 @@ bool Manager::restoreFromDisk(uint32_t id)
     entry->path(path, true);
 
     auto [it, inserted] = entries.emplace(id, std::move(entry));
+    indexEntry(*it->second);
 
     if (it->second->severity() >= Entry::sevLowerLimit)
     {
@@ -1023,6 +1518,10 @@ bool Manager::refreshFromDisk(uint32_t id)
 
     existingEntry->path(path, true);
 
+    // The severity may have changed.
+    unindexEntry(id);
+    indexEntry(*existingEntry);
+
     return true;
 }
 
@@ -10,13 +10,19 @@
 #include <phosphor-logging/lg2.hpp>
 #include <phosphor-logging/log.hpp>
 #include <sdbusplus/bus.hpp>
+#include <sdeventplus/source/event.hpp>
 #include <sdeventplus/source/io.hpp>
 #include <xyz/openbmc_project/Collection/DeleteAll/server.hpp>
 #include <xyz/openbmc_project/Logging/Create/server.hpp>
 #include <xyz/openbmc_project/Logging/Entry/server.hpp>
 #include <xyz/openbmc_project/Logging/event.hpp>
 
+#include <array>
+#include <chrono>
+#include <deque>
 #include <list>
+#include <optional>
+#include <set>
 
 namespace phosphor
 {
@@ -53,9 +59,37 @@ using FFDCEntry = std::tuple<CreateIface::FFDCFormat, uint8_t, uint8_t,
 
 using FFDCEntries = std::vector<FFDCEntry>;
 
+using BatchEntry =
+    std::tuple<std::string, Severity, std::map<std::string, std::string>>;
+
+using BatchEntries = std::vector<BatchEntry>;
+
+using QueryResult = std::tuple<uint32_t, uint64_t, Severity, std::string, bool>;
+
+using ResolvedFilter = details::ManagerIface::ResolvedFilter;
+
 namespace internal
 {
 
+/** @brief Counters for the queue of extension create calls */
+struct CreateQueueStats
+{
+    /** @brief Number of calls that have been queued */
+    size_t queued = 0;
+
+    /** @brief Number of calls made early because the queue was full */
+    size_t throttled = 0;
+
+    /** @brief The most calls that have been waiting at once */
+    size_t maxDepth = 0;
+
+    /** @brief Total time calls waited in the queue before being made */
+    std::chrono::microseconds totalLatency{0};
+
+    /** @brief Longest time a call waited in the queue before being made */
+    std::chrono::microseconds maxLatency{0};
+};
+
 /** @class Manager
  *  @brief OpenBMC logging manager implementation.
  *  @details A concrete implementation for the
@@ -120,6 +154,9 @@ class Manager : public details::ServerObject<details::ManagerIface>
 
     /** @brief Construct error d-bus objects from their persisted
      *         representations.
+     *  @details The persisted files are decoded on worker threads when
+     *           there are enough of them, and any format migration writes
+     *           are deferred until the event loop is running.
      */
     void restore();
 
@@ -198,6 +235,45 @@ class Manager : public details::ServerObject<details::ManagerIface>
                 const FFDCEntries& ffdc = FFDCEntries{})
         -> sdbusplus::object_path;
 
+    /** @brief sd_bus CreateBatch method implementation callback.
+     *
+     *  Creates a group of event logs the same way as create(), except that
+     *  the entries are persisted with a single sync to flash, and the error
+     *  caps are applied once, before the batch is added, by removing enough
+     *  existing entries to make room for it.  A batch holding more entries
+     *  of a kind than its cap allows is rejected with InvalidArgument.
+     *
+     * @param[in] batch - The message, severity, and AdditionalData of each
+     *                    event log
+     *
+     * @return The object paths of the new entries, in order
+     */
+    auto createBatch(BatchEntries batch)
+        -> std::vector<sdbusplus::object_path> override;
+
+    /** @brief sd_bus Query method implementation callback.
+     *
+     *  Finds the entries that match all of the filters, using the
+     *  severity index to only look at entries in the severity range.
+     *
+     * @param[in] highestSeverity - The most severe level to match
+     * @param[in] lowestSeverity - The least severe level to match
+     * @param[in] startTime - The earliest timestamp to match
+     * @param[in] endTime - The latest timestamp to match
+     * @param[in] resolved - Which entries to match based on Resolved
+     * @param[in] messagePrefix - The prefix the Message must start with
+     * @param[in] offset - The number of matching entries to skip
+     * @param[in] limit - The most entries to return, or 0 for no limit
+     *
+     * @return The ID, timestamp, severity, message, and resolved status of
+     *         the matching entries, newest first, and the number that
+     *         matched in total.
+     */
+    auto query(Severity highestSeverity, Severity lowestSeverity,
+               uint64_t startTime, uint64_t endTime, ResolvedFilter resolved,
+               std::string messagePrefix, uint32_t offset, uint32_t limit)
+        -> std::tuple<std::vector<QueryResult>, uint32_t> override;
+
     /** @brief Create an internal event log from the sdbusplus generated event
      *
      *  @param[in] event - The event to create.
@@ -205,7 +281,10 @@ class Manager : public details::ServerObject<details::ManagerIface>
     auto createFromEvent(sdbusplus::exception::generated_event_base&& event)
         -> sdbusplus::object_path;
 
-    /** @brief Common wrapper for creating an Entry object
+    /** @brief Check the QuiesceOnHwError setting
+     *
+     * @details The setting is cached and kept current with signal matches,
+     *          so it is only read over D-Bus when the cache is cold.
      *
      * @return true if quiesce on error setting is enabled, false otherwise
      */
@@ -231,6 +310,58 @@ class Manager : public details::ServerObject<details::ManagerIface>
      */
     void checkAndRemoveBlockingError(uint32_t entryId);
 
+    /** @brief Ask the extensions if an entry may be deleted
+     *
+     * @param[in] entryId - The entry to check
+     *
+     * @return true if an extension prohibits deleting the entry
+     */
+    bool isDeleteProhibited(uint32_t entryId);
+
+    /** @brief Erase a set of entries along with their persisted files,
+     *         blocking errors, and extension data.
+     *
+     * @details The bookkeeping is done in a single pass over each
+     *          container instead of once per entry, so erasing every
+     *          entry isn't quadratic.  The caller must have already
+     *          checked that the entries exist and may be deleted.
+     *
+     * @param[in] ids - The entries to erase
+     */
+    void eraseEntries(const std::set<uint32_t>& ids);
+
+    /** @brief Remove the persisted files of erased entries
+     *
+     * @details When no entries are left, the error directories are
+     *          renamed out of the way and removed on a separate thread,
+     *          instead of unlinking each file on the event loop.
+     *
+     * @param[in] ids - The erased entries
+     */
+    void removeEntryFiles(const std::set<uint32_t>& ids);
+
+    /** @brief Returns the number of extension create calls waiting to be
+     *         made
+     *
+     *  @return size_t - count of queued calls
+     */
+    size_t getPendingCreateSize() const
+    {
+        return pendingCreates.size();
+    }
+
+    /** @brief Returns the counters for the extension create queue
+     *
+     *  @return const CreateQueueStats&
+     */
+    const CreateQueueStats& getCreateQueueStats() const
+    {
+        return createQueueStats;
+    }
+
+    /** @brief Make all of the queued extension create calls now */
+    void flushPendingCreates();
+
     /**
      * @brief Sets up an inotify watch on the error entry directory.
      *
@@ -271,6 +402,31 @@ class Manager : public details::ServerObject<details::ManagerIface>
      */
     static std::string readFWVersion();
 
+    /** @brief Queue the extensions' create() calls for a new entry.
+     *
+     *  The calls are made from the event loop after the D-Bus reply for
+     *  the entry has been sent, in the order the entries were created.
+     *  If the queue is full, the oldest call is made before returning so
+     *  that callers are slowed down instead of the queue growing.
+     *
+     *  @param[in] entry - the new event log entry
+     *  @param[in] ffdc - A vector of FFDC file info.  The file descriptors
+     *                    are duplicated, since the caller's are closed
+     *                    once the method call returns.
+     */
+    void queueExtensionLogCreate(const Entry& entry, const FFDCEntries& ffdc);
+
+    /** @brief Make the oldest queued extension create call */
+    void runPendingCreate();
+
+    /** @brief Make the queued extension create calls from the event
+     *         loop, a limited number per iteration so that method calls
+     *         are still handled in between.
+     *
+     *  @param[in] source - The event source object used
+     */
+    void processPendingCreates(sdeventplus::source::EventBase& source);
+
     /** @brief Call any create() functions provided by any extensions.
      *  This is called right after an event log is created to allow
      *  extensions to create their own log based on this one.
@@ -294,6 +450,25 @@ class Manager : public details::ServerObject<details::ManagerIface>
                      const FFDCEntries& ffdc = FFDCEntries{})
         -> sdbusplus::object_path;
 
+    /** @brief Assign an ID to a new entry and create its d-bus object
+     *
+     * @param[in] errMsg - The error exception message
+     * @param[in] errLvl - level of the error
+     * @param[in] additionalData - The AdditionalData property for the error
+     *
+     * @return The new entry
+     */
+    Entry& addEntry(std::string errMsg, Entry::Level errLvl,
+                    std::map<std::string, std::string> additionalData);
+
+    /** @brief Quiesce on the new entry if enabled, and then queue the
+     *         extensions' create functions.
+     *
+     * @param[in] entry - The new entry, which has already been persisted
+     * @param[in] ffdc - A vector of FFDC file info
+     */
+    void entryCreated(const Entry& entry, const FFDCEntries& ffdc);
+
     /** @brief Notified on entry property changes
      *
      * If an entry is blocking, this callback will be registered to monitor for
@@ -307,6 +482,24 @@ class Manager : public details::ServerObject<details::ManagerIface>
     /** @brief Remove block objects for any resolved entries  */
     void findAndRemoveResolvedBlocks();
 
+    /** @brief Add an entry to the severity index
+     *
+     * @param[in] entry - The entry
+     */
+    void indexEntry(const Entry& entry);
+
+    /** @brief Remove an entry from the severity index
+     *
+     * @param[in] id - The ID of the entry
+     */
+    void unindexEntry(uint32_t id);
+
+    /** @brief Keep the cached QuiesceOnHwError setting up to date with
+     *         PropertiesChanged and InterfacesAdded matches, and clear it
+     *         when the settings service goes away.
+     */
+    void watchQuiesceOnErrorSetting();
+
     /** @brief Quiesce host if it is running
      *
      * This is called when the user has requested the system be quiesced
@@ -322,6 +515,16 @@ class Manager : public details::ServerObject<details::ManagerIface>
      */
     bool restoreFromDisk(uint32_t id);
 
+    /** @brief Write the Cereal files for entries that were restored from
+     *         JSON only.
+     *
+     * Called from the event loop after restore() so that the writes don't
+     * delay startup.
+     *
+     * @param[in] source - The event source object used
+     */
+    void migrateEntries(sdeventplus::source::EventBase& source);
+
     /** @brief Refresh a single error entry from disk
      *
      * @param[in] id - The entry ID to refresh
@@ -362,9 +565,64 @@ class Manager : public details::ServerObject<details::ManagerIface>
     std::map<uint32_t, std::unique_ptr<sdbusplus::match>>
         propChangedEntryCallback;
 
+    /** @brief The IDs of the entries at each severity level, for
+     *         query()
+     */
+    std::array<std::set<uint32_t>, 8> severityIndex;
+
+    /** @brief The cached QuiesceOnHwError setting, if it has been read */
+    std::optional<bool> quiesceOnHwError;
+
+    /** @brief Matches that keep quiesceOnHwError up to date */
+    std::vector<sdbusplus::match> quiesceSettingMatches;
+
     /** @brief Encodes the BMC position in the entryId when enabled */
     std::unique_ptr<BMCPosMgr> bmcPosMgr;
 
+    /** @brief IDs of restored entries that still need a Cereal file */
+    std::vector<uint32_t> pendingMigrations;
+
+    /** @brief An extension create call waiting to be made */
+    struct PendingCreate
+    {
+        PendingCreate(uint32_t id, const FFDCEntries& ffdc);
+        ~PendingCreate();
+        PendingCreate(const PendingCreate&) = delete;
+        PendingCreate& operator=(const PendingCreate&) = delete;
+        PendingCreate(PendingCreate&&) = delete;
+        PendingCreate& operator=(PendingCreate&&) = delete;
+
+        /** @brief The ID of the new entry */
+        uint32_t id;
+
+        /** @brief The FFDC info, with duplicated file descriptors */
+        FFDCEntries ffdc;
+
+        /** @brief When the call was queued */
+        std::chrono::steady_clock::time_point queued;
+    };
+
+    /** @brief The most extension create calls that may be waiting */
+    static constexpr size_t maxPendingCreates = 64;
+
+    /** @brief The most extension create calls made per loop iteration */
+    static constexpr size_t maxCreatesPerDispatch = 16;
+
+    /** @brief How long one loop iteration may spend making those calls */
+    static constexpr std::chrono::milliseconds createDispatchBudget{100};
+
+    /** @brief Extension create calls waiting to be made, oldest first */
+    std::deque<std::unique_ptr<PendingCreate>> pendingCreates;
+
+    /** @brief Event source used to run processPendingCreates() */
+    std::unique_ptr<sdeventplus::source::Defer> createEventSource;
+
+    /** @brief Counters for the extension create queue */
+    CreateQueueStats createQueueStats;
+
+    /** @brief Event source used to run migrateEntries() */
+    std::unique_ptr<sdeventplus::source::Defer> migrationEventSource;
+
     /**
      * @brief Event source used to monitor error entry directory changes.
      */
@@ -0,0 +1,244 @@
+#include "config.h"
+
+#include "extensions.hpp"
+#include "log_manager.hpp"
+#include "paths.hpp"
+#include "util.hpp"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <sdbusplus/test/sdbus_mock.hpp>
+#include <sdeventplus/event.hpp>
+
+#include <filesystem>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace logging
+{
+namespace test
+{
+
+namespace fs = std::filesystem;
+
+// The IDs passed to the create function, in order.
+std::vector<uint32_t> createdIDs;
+
+// The contents of the FFDC files passed to the create function.
+std::vector<std::string> ffdcData;
+
+void createMock(const std::string& /*message*/, uint32_t id,
+                uint64_t /*timestamp*/, Entry::Level /*severity*/,
+                const AdditionalDataArg& /*additionalData*/,
+                const AssociationEndpointsArg& /*assocs*/, const FFDCArg& ffdc)
+{
+    createdIDs.push_back(id);
+
+    // Like the PEL extension, make sure the journal has the entry's data.
+    util::journalSync();
+
+    for (const auto& entry : ffdc)
+    {
+        int fd = std::get<ffdcFDPos>(entry);
+        std::string data(64, '\0');
+        auto size = pread(fd, data.data(), data.size(), 0);
+        data.resize(std::max<ssize_t>(size, 0));
+        ffdcData.push_back(data);
+    }
+}
+
+REGISTER_EXTENSION_FUNCTION(createMock)
+
+class TestExtensionCreate : public testing::Test
+{
+  public:
+    TestExtensionCreate() :
+        bus(sdbusplus::get_mocked_new(&sdbusMock)),
+        event(sdeventplus::Event::get_default())
+    {
+        fs::remove_all(paths::error());
+        fs::create_directories(paths::error());
+        createdIDs.clear();
+        ffdcData.clear();
+    }
+
+    ~TestExtensionCreate() override
+    {
+        fs::remove_all(paths::error());
+    }
+
+    // Run the event loop until the queued calls have been made.
+    void runQueue(internal::Manager& manager)
+    {
+        for (int i = 0; (i < 1000) && (manager.getPendingCreateSize() > 0);
+             i++)
+        {
+            event.run(std::chrono::milliseconds(0));
+        }
+    }
+
+    sdbusplus::SdBusMock sdbusMock;
+    sdbusplus::bus_t bus;
+    sdeventplus::Event event;
+};
+
+// The create functions are called from the event loop, in order.
+TEST_F(TestExtensionCreate, testQueued)
+{
+    internal::Manager manager(bus, OBJ_INTERNAL);
+
+    manager.create("test error", Entry::Level::Error, {});
+    manager.create("test error", Entry::Level::Informational, {});
+    manager.create("test error", Entry::Level::Error, {});
+
+    EXPECT_TRUE(createdIDs.empty());
+    EXPECT_EQ(manager.getPendingCreateSize(), 3);
+
+    runQueue(manager);
+
+    EXPECT_EQ(manager.getPendingCreateSize(), 0);
+    EXPECT_EQ(createdIDs, (std::vector<uint32_t>{1, 2, 3}));
+
+    const auto& stats = manager.getCreateQueueStats();
+    EXPECT_EQ(stats.queued, 3);
+    EXPECT_EQ(stats.maxDepth, 3);
+    EXPECT_EQ(stats.throttled, 0);
+    EXPECT_GE(stats.totalLatency, stats.maxLatency);
+}
+
+// The journal syncs the create functions ask for are coalesced when
+// the calls are made in the same event loop iteration.
+TEST_F(TestExtensionCreate, testJournalSyncCoalesced)
+{
+    internal::Manager manager(bus, OBJ_INTERNAL);
+
+    manager.create("test error", Entry::Level::Error, {});
+    manager.create("test error", Entry::Level::Error, {});
+    manager.create("test error", Entry::Level::Error, {});
+
+    auto before = util::getJournalSyncStats();
+
+    runQueue(manager);
+
+    const auto& after = util::getJournalSyncStats();
+    EXPECT_EQ(createdIDs.size(), 3);
+    EXPECT_EQ(after.requests - before.requests, 3);
+    EXPECT_EQ(after.coalesced - before.coalesced, 2);
+    EXPECT_EQ(after.failures, before.failures);
+}
+
+// The caps are applied before a batch is added, so none of its entries
+// are removed again and their create functions are all called.
+TEST_F(TestExtensionCreate, testBatchCaps)
+{
+    internal::Manager manager(bus, OBJ_INTERNAL);
+
+    for (size_t i = 0; i < ERROR_INFO_CAP; i++)
+    {
+        manager.create("test info", Entry::Level::Informational, {});
+    }
+
+    runQueue(manager);
+    createdIDs.clear();
+
+    auto paths = manager.createBatch(
+        {{"test info", Entry::Level::Informational, {}},
+         {"test info", Entry::Level::Informational, {}}});
+
+    EXPECT_EQ(manager.getInfoErrSize(), ERROR_INFO_CAP);
+
+    runQueue(manager);
+
+    std::vector<uint32_t> batchIDs{ERROR_INFO_CAP + 1, ERROR_INFO_CAP + 2};
+    EXPECT_EQ(createdIDs, batchIDs);
+
+    ASSERT_EQ(paths.size(), 2);
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        EXPECT_EQ(paths[i].filename(), std::to_string(batchIDs[i]));
+        EXPECT_TRUE(manager.entries.contains(batchIDs[i]));
+    }
+
+    // The oldest entries made room for the batch.
+    EXPECT_FALSE(manager.entries.contains(1));
+    EXPECT_FALSE(manager.entries.contains(2));
+    EXPECT_TRUE(manager.entries.contains(3));
+}
+
+// A batch that is over a cap by itself is rejected.
+TEST_F(TestExtensionCreate, testBatchOverCap)
+{
+    internal::Manager manager(bus, OBJ_INTERNAL);
+
+    BatchEntry info{"test info", Entry::Level::Informational, {}};
+    BatchEntries batch(ERROR_INFO_CAP + 1, info);
+
+    EXPECT_THROW(
+        manager.createBatch(batch),
+        sdbusplus::xyz::openbmc_project::Common::Error::InvalidArgument);
+
+    EXPECT_EQ(manager.getInfoErrSize(), 0);
+    EXPECT_TRUE(manager.entries.empty());
+}
+
+// The FFDC files can still be read after the caller closed them.
+TEST_F(TestExtensionCreate, testFFDC)
+{
+    internal::Manager manager(bus, OBJ_INTERNAL);
+
+    int fd = memfd_create("ffdc", MFD_CLOEXEC);
+    ASSERT_NE(fd, -1);
+    ASSERT_EQ(write(fd, "ffdc data", 9), 9);
+
+    FFDCEntries ffdc{{CreateIface::FFDCFormat::Text, 1, 2, fd}};
+    manager.create("test error", Entry::Level::Error, {}, ffdc);
+    close(fd);
+
+    runQueue(manager);
+
+    EXPECT_EQ(createdIDs.size(), 1);
+    EXPECT_EQ(ffdcData, (std::vector<std::string>{"ffdc data"}));
+}
+
+// When the queue is full, the oldest call is made right away.
+TEST_F(TestExtensionCreate, testFull)
+{
+    internal::Manager manager(bus, OBJ_INTERNAL);
+
+    size_t queued = 0;
+    while (createdIDs.empty() && (queued < 1000))
+    {
+        manager.create("test error", Entry::Level::Error, {});
+        queued++;
+    }
+
+    ASSERT_EQ(createdIDs.size(), 1);
+    EXPECT_EQ(createdIDs[0], 1);
+    EXPECT_EQ(manager.getPendingCreateSize(), queued - 1);
+    EXPECT_EQ(manager.getCreateQueueStats().throttled, 1);
+
+    runQueue(manager);
+    EXPECT_EQ(createdIDs.size(), queued);
+}
+
+// The call isn't made for an entry deleted while it was waiting.
+TEST_F(TestExtensionCreate, testErased)
+{
+    internal::Manager manager(bus, OBJ_INTERNAL);
+
+    manager.create("test error", Entry::Level::Error, {});
+    manager.create("test error", Entry::Level::Error, {});
+    manager.erase(1);
+
+    EXPECT_EQ(manager.getPendingCreateSize(), 1);
+
+    runQueue(manager);
+    EXPECT_EQ(createdIDs, (std::vector<uint32_t>{2}));
+}
+
+} // namespace test
+} // namespace logging
+} // namespace phosphor
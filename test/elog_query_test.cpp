@@ -0,0 +1,153 @@
+#include "config.h"
+
+#include "log_manager.hpp"
+#include "paths.hpp"
+
+#include <sdbusplus/test/sdbus_mock.hpp>
+
+#include <filesystem>
+#include <limits>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace logging
+{
+namespace test
+{
+
+namespace fs = std::filesystem;
+
+constexpr auto maxTime = std::numeric_limits<uint64_t>::max();
+
+class TestQuery : public testing::Test
+{
+  public:
+    TestQuery() :
+        bus(sdbusplus::get_mocked_new(&sdbusMock)),
+        manager(bus, OBJ_INTERNAL)
+    {
+        fs::remove_all(paths::error());
+        fs::create_directories(paths::error());
+
+        // IDs 1 - 6
+        manager.create("xyz.openbmc_project.Error.A", Entry::Level::Error, {});
+        manager.create("xyz.openbmc_project.Error.B", Entry::Level::Critical,
+                       {});
+        manager.create("xyz.openbmc_project.Event.C",
+                       Entry::Level::Informational, {});
+        manager.create("xyz.openbmc_project.Error.D", Entry::Level::Error, {});
+        manager.create("xyz.openbmc_project.Error.E", Entry::Level::Warning,
+                       {});
+        manager.create("xyz.openbmc_project.Error.F", Entry::Level::Error, {});
+
+        manager.entries.at(4)->resolved(true);
+    }
+
+    ~TestQuery() override
+    {
+        fs::remove_all(paths::error());
+    }
+
+    // Return the IDs from a query result.
+    static std::vector<uint32_t> ids(
+        const std::tuple<std::vector<QueryResult>, uint32_t>& result)
+    {
+        std::vector<uint32_t> ids;
+        for (const auto& entry : std::get<0>(result))
+        {
+            ids.push_back(std::get<0>(entry));
+        }
+        return ids;
+    }
+
+    sdbusplus::SdBusMock sdbusMock;
+    sdbusplus::bus_t bus;
+    internal::Manager manager;
+};
+
+TEST_F(TestQuery, testAll)
+{
+    auto result = manager.query(Entry::Level::Emergency, Entry::Level::Debug,
+                                0, maxTime, ResolvedFilter::Any, "", 0, 0);
+
+    EXPECT_EQ(ids(result), (std::vector<uint32_t>{6, 5, 4, 3, 2, 1}));
+    EXPECT_EQ(std::get<1>(result), 6);
+
+    const auto& [id, timestamp, severity, message, resolved] =
+        std::get<0>(result)[2];
+    EXPECT_EQ(id, 4);
+    EXPECT_EQ(timestamp, manager.entries.at(4)->timestamp());
+    EXPECT_EQ(severity, Entry::Level::Error);
+    EXPECT_EQ(message, "xyz.openbmc_project.Error.D");
+    EXPECT_TRUE(resolved);
+}
+
+TEST_F(TestQuery, testFilters)
+{
+    // Severity
+    auto result = manager.query(Entry::Level::Critical, Entry::Level::Error, 0,
+                                maxTime, ResolvedFilter::Any, "", 0, 0);
+    EXPECT_EQ(ids(result), (std::vector<uint32_t>{6, 4, 2, 1}));
+
+    // Resolved
+    result = manager.query(Entry::Level::Emergency, Entry::Level::Debug, 0,
+                           maxTime, ResolvedFilter::Resolved, "", 0, 0);
+    EXPECT_EQ(ids(result), (std::vector<uint32_t>{4}));
+
+    result = manager.query(Entry::Level::Error, Entry::Level::Error, 0,
+                           maxTime, ResolvedFilter::Unresolved, "", 0, 0);
+    EXPECT_EQ(ids(result), (std::vector<uint32_t>{6, 1}));
+
+    // Message
+    result = manager.query(Entry::Level::Emergency, Entry::Level::Debug, 0,
+                           maxTime, ResolvedFilter::Any,
+                           "xyz.openbmc_project.Event.", 0, 0);
+    EXPECT_EQ(ids(result), (std::vector<uint32_t>{3}));
+
+    // Time
+    auto start = manager.entries.at(5)->timestamp();
+    result = manager.query(Entry::Level::Emergency, Entry::Level::Debug,
+                           start + 1, maxTime, ResolvedFilter::Any, "", 0, 0);
+    EXPECT_TRUE(std::get<0>(result).empty());
+    EXPECT_EQ(std::get<1>(result), 0);
+
+    auto end = manager.entries.at(1)->timestamp();
+    result = manager.query(Entry::Level::Emergency, Entry::Level::Debug, 0,
+                           end, ResolvedFilter::Any, "", 0, 0);
+    EXPECT_EQ(ids(result).back(), 1);
+}
+
+TEST_F(TestQuery, testPages)
+{
+    auto result = manager.query(Entry::Level::Emergency, Entry::Level::Debug,
+                                0, maxTime, ResolvedFilter::Any, "", 0, 4);
+    EXPECT_EQ(ids(result), (std::vector<uint32_t>{6, 5, 4, 3}));
+    EXPECT_EQ(std::get<1>(result), 6);
+
+    result = manager.query(Entry::Level::Emergency, Entry::Level::Debug, 0,
+                           maxTime, ResolvedFilter::Any, "", 4, 4);
+    EXPECT_EQ(ids(result), (std::vector<uint32_t>{2, 1}));
+    EXPECT_EQ(std::get<1>(result), 6);
+
+    result = manager.query(Entry::Level::Emergency, Entry::Level::Debug, 0,
+                           maxTime, ResolvedFilter::Any, "", 10, 4);
+    EXPECT_TRUE(std::get<0>(result).empty());
+    EXPECT_EQ(std::get<1>(result), 6);
+}
+
+TEST_F(TestQuery, testErased)
+{
+    manager.erase(6);
+    manager.erase(2);
+
+    auto result = manager.query(Entry::Level::Emergency, Entry::Level::Debug,
+                                0, maxTime, ResolvedFilter::Any, "", 0, 0);
+    EXPECT_EQ(ids(result), (std::vector<uint32_t>{5, 4, 3, 1}));
+    EXPECT_EQ(std::get<1>(result), 4);
+}
+
+} // namespace test
+} // namespace logging
+} // namespace phosphor
@@ -0,0 +1,186 @@
+#include "config.h"
+
+#include "elog_entry.hpp"
+#include "elog_serialize.hpp"
+#include "log_manager.hpp"
+#include "paths.hpp"
+
+#include <sdbusplus/test/sdbus_mock.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace logging
+{
+namespace test
+{
+
+namespace fs = std::filesystem;
+
+class TestRestore : public testing::Test
+{
+  public:
+    TestRestore() : bus(sdbusplus::get_mocked_new(&sdbusMock))
+    {
+        fs::remove_all(paths::error());
+        fs::remove_all(paths::error_json());
+        fs::create_directories(paths::error());
+        fs::create_directories(paths::error_json());
+    }
+
+    ~TestRestore() override
+    {
+        fs::remove_all(paths::error());
+        fs::remove_all(paths::error_json());
+    }
+
+    sdbusplus::SdBusMock sdbusMock;
+    sdbusplus::bus_t bus;
+};
+
+// Restore enough entries that they are decoded on multiple threads.
+TEST_F(TestRestore, testRestoreMany)
+{
+    constexpr uint32_t numEntries = 300;
+
+    {
+        internal::Manager writer(bus, OBJ_INTERNAL);
+
+        for (uint32_t id = 1; id <= numEntries; id++)
+        {
+            auto level = (id % 2) ? Entry::Level::Error
+                                  : Entry::Level::Informational;
+            Entry e{bus,
+                    std::string(OBJ_ENTRY) + '/' + std::to_string(id),
+                    id,
+                    id * 100,
+                    level,
+                    "test error " + std::to_string(id),
+                    {{"ID", std::to_string(id)}},
+                    {},
+                    "level42",
+                    getEntrySerializePath(id),
+                    writer};
+            serialize(e);
+
+            // Also write JSON for some, like older code levels did.
+            if (id % 10 == 0)
+            {
+                serializeJSON(e);
+            }
+        }
+    }
+
+    // A leftover from an interrupted write
+    std::ofstream{paths::error() / ".7.tmp"} << "garbage";
+
+    internal::Manager manager(bus, OBJ_INTERNAL);
+    manager.restore();
+
+    ASSERT_EQ(manager.entries.size(), numEntries);
+    EXPECT_EQ(manager.getRealErrSize(), numEntries / 2);
+    EXPECT_EQ(manager.getInfoErrSize(), numEntries / 2);
+    EXPECT_FALSE(fs::exists(paths::error() / ".7.tmp"));
+
+    for (const auto& [id, entry] : manager.entries)
+    {
+        EXPECT_EQ(entry->id(), id);
+        EXPECT_EQ(entry->timestamp(), id * 100);
+        EXPECT_EQ(entry->message(), "test error " + std::to_string(id));
+        EXPECT_EQ(entry->additionalData().at("ID"), std::to_string(id));
+        EXPECT_EQ(entry->path(), getEntrySerializePath(id));
+
+        // The stale JSON files were removed.
+        EXPECT_FALSE(
+            fs::exists(paths::error_json() / (std::to_string(id) + ".json")));
+    }
+}
+
+// An entry that only has a JSON file is restored from it.
+TEST_F(TestRestore, testRestoreJSONOnly)
+{
+    uint32_t id = 42;
+
+    {
+        internal::Manager writer(bus, OBJ_INTERNAL);
+        Entry e{bus,
+                std::string(OBJ_ENTRY) + '/' + std::to_string(id),
+                id,
+                100,
+                Entry::Level::Warning,
+                "json error",
+                {},
+                {},
+                "level42",
+                getEntrySerializePath(id),
+                writer};
+        serializeJSON(e);
+    }
+
+    internal::Manager manager(bus, OBJ_INTERNAL);
+    manager.restore();
+
+    ASSERT_EQ(manager.entries.size(), 1);
+    auto& entry = manager.entries.at(id);
+    EXPECT_EQ(entry->message(), "json error");
+    EXPECT_EQ(entry->severity(), Entry::Level::Warning);
+
+    // The Cereal file is written later from the event loop.
+    EXPECT_EQ(entry->path(), getEntrySerializePath(id));
+}
+
+// Erasing all of the entries removes them and their files in one go.
+TEST_F(TestRestore, testEraseAll)
+{
+    constexpr uint32_t numEntries = 50;
+
+    {
+        internal::Manager writer(bus, OBJ_INTERNAL);
+
+        for (uint32_t id = 1; id <= numEntries; id++)
+        {
+            auto level = (id % 2) ? Entry::Level::Error
+                                  : Entry::Level::Informational;
+            Entry e{bus,
+                    std::string(OBJ_ENTRY) + '/' + std::to_string(id),
+                    id,
+                    id * 100,
+                    level,
+                    "test error " + std::to_string(id),
+                    {},
+                    {},
+                    "level42",
+                    getEntrySerializePath(id),
+                    writer};
+            serialize(e);
+            serializeJSON(e);
+        }
+    }
+
+    internal::Manager manager(bus, OBJ_INTERNAL);
+    manager.restore();
+    ASSERT_EQ(manager.entries.size(), numEntries);
+
+    EXPECT_EQ(manager.eraseAll(), numEntries);
+    EXPECT_TRUE(manager.entries.empty());
+    EXPECT_EQ(manager.getRealErrSize(), 0);
+    EXPECT_EQ(manager.getInfoErrSize(), 0);
+
+    // The directories are still there for new entries, but empty.
+    ASSERT_TRUE(fs::exists(paths::error()));
+    ASSERT_TRUE(fs::exists(paths::error_json()));
+    EXPECT_TRUE(fs::is_empty(paths::error()));
+    EXPECT_TRUE(fs::is_empty(paths::error_json()));
+
+    internal::Manager restored(bus, OBJ_INTERNAL);
+    restored.restore();
+    EXPECT_TRUE(restored.entries.empty());
+}
+
+} // namespace test
+} // namespace logging
+} // namespace phosphor
@@ -27,6 +27,8 @@ void deleteLog1(uint32_t /*id*/) {}
 
 void deleteLog2(uint32_t /*id*/) {}
 
+void deleteLogs(const std::set<uint32_t>& /*ids*/) {}
+
 void deleteProhibited1(uint32_t /*id*/, bool& prohibited)
 {
     prohibited = true;
@@ -58,6 +60,7 @@ REGISTER_EXTENSION_FUNCTION(logIDWithHwIsolation1)
 REGISTER_EXTENSION_FUNCTION(logIDWithHwIsolation2)
 REGISTER_EXTENSION_FUNCTION(deleteLog1)
 REGISTER_EXTENSION_FUNCTION(deleteLog2)
+REGISTER_EXTENSION_FUNCTION(deleteLogs)
 
 TEST(ExtensionsTest, FunctionCallTest)
 {
@@ -86,6 +89,12 @@ TEST(ExtensionsTest, FunctionCallTest)
         d(5);
     }
 
+    EXPECT_EQ(Extensions::getDeleteManyFunctions().size(), 1);
+    for (auto& d : Extensions::getDeleteManyFunctions())
+    {
+        d({5, 6});
+    }
+
     EXPECT_EQ(Extensions::getDeleteProhibitedFunctions().size(), 2);
     for (auto& p : Extensions::getDeleteProhibitedFunctions())
     {
@@ -0,0 +1,53 @@
+#include "config.h"
+
+#include "util.hpp"
+
+#include <systemd/sd-journal.h>
+#include <unistd.h>
+
+#include <cinttypes>
+#include <set>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+// The lookup reads the real journal, so journald must be running.  Raise
+// its RateLimitBurst for the larger journal sizes, or the entries logged
+// to grow the journal are dropped.
+const char* PERSIST_PATH_ROOT = "/tmp/phosphor-logging";
+const bool IS_UNIT_TEST = false;
+
+using namespace phosphor::logging;
+
+// Measure finding a transaction's metadata as the number of entries that
+// were logged after it grows, like a commit made during a flood of logs.
+static void BM_TransactionLookup(benchmark::State& state)
+{
+    auto entries = static_cast<uint64_t>(state.range(0));
+    uint64_t transactionId = (static_cast<uint64_t>(getpid()) << 32) |
+                             entries;
+
+    sd_journal_send("MESSAGE=Benchmark transaction",
+                    "TRANSACTION_ID=%" PRIu64, transactionId,
+                    "BENCHMARK_FIELD=%" PRIu64, entries, nullptr);
+
+    for (uint64_t i = 0; i < entries; i++)
+    {
+        sd_journal_send("MESSAGE=Benchmark filler", "TRANSACTION_ID=%" PRIu64,
+                        transactionId + ((i + 1) << 20), nullptr);
+    }
+
+    util::journalSync();
+
+    for (auto _ : state)
+    {
+        std::set<std::string> fields{"BENCHMARK_FIELD", "_PID"};
+        auto data = util::readTransactionData(transactionId, fields);
+        if (!data || !fields.empty())
+        {
+            state.SkipWithError("The transaction wasn't found in the journal");
+            break;
+        }
+    }
+}
+BENCHMARK(BM_TransactionLookup)->RangeMultiplier(10)->Range(10, 10000);
@@ -0,0 +1,167 @@
+#include <systemd/sd-journal.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// Enable the async writer before the first log.
+static const int asyncEnabled = setenv("LG2_ASYNC", "16", 1);
+
+namespace
+{
+struct JournalEntry
+{
+    std::map<std::string, std::string> fields;
+    std::thread::id thread;
+};
+
+std::mutex mutex;
+std::condition_variable changed;
+std::vector<JournalEntry> entries;
+bool blocked = false;
+bool writerBlocked = false;
+
+std::string message(const JournalEntry& entry)
+{
+    return entry.fields.at("MESSAGE");
+}
+
+// Wait for a number of entries to be sent.
+bool waitForEntries(size_t count)
+{
+    std::unique_lock lock{mutex};
+    return changed.wait_for(lock, std::chrono::seconds(5),
+                            [count]() { return entries.size() >= count; });
+}
+} // namespace
+
+// Capture the entries sent to the journal by overriding the libsystemd
+// function.
+extern "C" int sd_journal_sendv(const struct iovec* iov, int n)
+{
+    JournalEntry entry;
+    entry.thread = std::this_thread::get_id();
+    for (int i = 0; i < n; i++)
+    {
+        std::string field{static_cast<const char*>(iov[i].iov_base),
+                          iov[i].iov_len};
+        auto pos = field.find('=');
+        entry.fields.emplace(field.substr(0, pos), field.substr(pos + 1));
+    }
+
+    std::unique_lock lock{mutex};
+    if (blocked)
+    {
+        writerBlocked = true;
+        changed.notify_all();
+        changed.wait(lock, []() { return !blocked; });
+    }
+    entries.push_back(std::move(entry));
+    changed.notify_all();
+    return 0;
+}
+
+class LG2Async : public testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        ASSERT_EQ(asyncEnabled, 0);
+        std::scoped_lock lock{mutex};
+        entries.clear();
+    }
+};
+
+TEST_F(LG2Async, InfoIsQueued)
+{
+    lg2::info("Info {NUM}", "NUM", 1);
+    lg2::warning("Warning {NUM}", "NUM", 2);
+
+    ASSERT_TRUE(waitForEntries(2));
+    std::scoped_lock lock{mutex};
+    EXPECT_EQ(message(entries[0]), "Info 1");
+    EXPECT_EQ(message(entries[1]), "Warning 2");
+    EXPECT_EQ(entries[0].fields.at("NUM"), "1");
+    EXPECT_EQ(entries[0].fields.at("PRIORITY"), "6");
+    EXPECT_NE(entries[0].thread, std::this_thread::get_id());
+}
+
+TEST_F(LG2Async, ErrorIsSentDirectly)
+{
+    lg2::error("Error");
+
+    std::scoped_lock lock{mutex};
+    ASSERT_EQ(entries.size(), 1);
+    EXPECT_EQ(message(entries[0]), "Error");
+    EXPECT_EQ(entries[0].thread, std::this_thread::get_id());
+}
+
+TEST_F(LG2Async, LargeIsSentDirectly)
+{
+    std::string large(3000, 'x');
+    lg2::info("Large {VALUE}", "VALUE", large);
+
+    std::scoped_lock lock{mutex};
+    ASSERT_EQ(entries.size(), 1);
+    EXPECT_EQ(entries[0].fields.at("VALUE"), large);
+    EXPECT_EQ(entries[0].thread, std::this_thread::get_id());
+    EXPECT_FALSE(entries[0].fields.contains("LOG2_DROPPED"));
+}
+
+TEST_F(LG2Async, Overflow)
+{
+    // Block the writer thread on the first entry, so the rest fill the
+    // queue.
+    {
+        std::scoped_lock lock{mutex};
+        blocked = true;
+    }
+
+    lg2::info("Blocked");
+    {
+        std::unique_lock lock{mutex};
+        ASSERT_TRUE(changed.wait_for(lock, std::chrono::seconds(5),
+                                     []() { return writerBlocked; }));
+    }
+
+    for (int i = 0; i < 20; i++)
+    {
+        lg2::info("Entry {NUM}", "NUM", i);
+    }
+
+    {
+        std::scoped_lock lock{mutex};
+        blocked = false;
+        changed.notify_all();
+    }
+
+    // The queue holds 16 entries, including the blocked one, so 5 were
+    // dropped.
+    ASSERT_TRUE(waitForEntries(16));
+
+    lg2::info("After");
+    ASSERT_TRUE(waitForEntries(17));
+
+    std::scoped_lock lock{mutex};
+    ASSERT_EQ(entries.size(), 17);
+    EXPECT_EQ(message(entries[0]), "Blocked");
+    for (int i = 0; i < 15; i++)
+    {
+        EXPECT_EQ(message(entries[i + 1]), "Entry " + std::to_string(i));
+    }
+    EXPECT_EQ(message(entries[16]), "After");
+
+    // The first entry sent after the drops reports them.
+    EXPECT_FALSE(entries[0].fields.contains("LOG2_DROPPED"));
+    EXPECT_EQ(entries[1].fields.at("LOG2_DROPPED"), "5");
+    EXPECT_FALSE(entries[2].fields.contains("LOG2_DROPPED"));
+}
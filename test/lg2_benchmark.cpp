@@ -0,0 +1,63 @@
+#include <systemd/sd-journal.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+// Measure just the formatting by not sending anything to the journal.
+extern "C" int sd_journal_sendv(const struct iovec*, int)
+{
+    return 0;
+}
+
+static void BM_MessageOnly(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        lg2::info("A log message without any headers");
+    }
+}
+BENCHMARK(BM_MessageOnly);
+
+static void BM_Headers(benchmark::State& state)
+{
+    std::string path{"/xyz/openbmc_project/logging/entry/42"};
+
+    for (auto _ : state)
+    {
+        lg2::error("Failed to read {PATH} at offset {OFFSET}: {RC}", "PATH",
+                   path, "OFFSET", lg2::hex, 0x1000, "RC", -5, "RETRY", true);
+    }
+}
+BENCHMARK(BM_Headers);
+
+static void BM_ManyHeaders(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        lg2::info("{H1} {H2} {H3} {H4} {H5} {H6} {H7} {H8}", "H1", 1, "H2",
+                  lg2::hex | lg2::field32, 2, "H3", 3.0, "H4", -4, "H5",
+                  lg2::bin | lg2::field8, 5, "H6", 6, "H7", 7, "H8",
+                  std::string(100, '8'));
+    }
+}
+BENCHMARK(BM_ManyHeaders);
+
+static void BM_DisabledLevel(benchmark::State& state)
+{
+    lg2::set_level(lg2::level::info);
+    std::string path{"/xyz/openbmc_project/logging/entry/42"};
+
+    for (auto _ : state)
+    {
+        lg2::debug("Reading {PATH} at offset {OFFSET}", "PATH", path, "OFFSET",
+                   lg2::hex, 0x1000);
+    }
+
+    lg2::set_level(lg2::level::debug);
+}
+BENCHMARK(BM_DisabledLevel);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,139 @@
+#include <systemd/sd-journal.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <map>
+#include <string>
+
+#include <gtest/gtest.h>
+
+// The fields sent to the journal by the last log, captured by overriding
+// the libsystemd function.
+static std::multimap<std::string, std::string> journalFields;
+
+extern "C" int sd_journal_sendv(const struct iovec* iov, int n)
+{
+    journalFields.clear();
+    for (int i = 0; i < n; i++)
+    {
+        std::string field{static_cast<const char*>(iov[i].iov_base),
+                          iov[i].iov_len};
+        auto pos = field.find('=');
+        journalFields.emplace(field.substr(0, pos), field.substr(pos + 1));
+    }
+    return 0;
+}
+
+namespace
+{
+std::string field(const std::string& name)
+{
+    auto it = journalFields.find(name);
+    return (it == journalFields.end()) ? "<missing>" : it->second;
+}
+
+// A type that counts how often it is converted for logging.
+struct Counted
+{
+    int conversions = 0;
+};
+
+std::string to_string(Counted& c)
+{
+    c.conversions++;
+    return "counted";
+}
+} // namespace
+
+TEST(LG2Logger, StaticFields)
+{
+    lg2::error("A message");
+
+    EXPECT_EQ(field("MESSAGE"), "A message");
+    EXPECT_EQ(field("LOG2_FMTMSG"), "A message");
+    EXPECT_EQ(field("PRIORITY"), "3");
+    EXPECT_EQ(field("CODE_LINE"), std::to_string(__LINE__ - 5));
+    EXPECT_NE(field("CODE_FILE"), "<missing>");
+    EXPECT_NE(field("CODE_FUNC"), "<missing>");
+}
+
+TEST(LG2Logger, Substitution)
+{
+    lg2::info("Value {NUM} of {NAME}, {MISSING} {NUM} {", "NAME",
+              std::string{"thing"}, "NUM", 42);
+
+    EXPECT_EQ(field("MESSAGE"), "Value 42 of thing, {MISSING} {NUM} {");
+    EXPECT_EQ(field("LOG2_FMTMSG"), "Value {NUM} of {NAME}, {MISSING} {NUM} {");
+    EXPECT_EQ(field("NAME"), "thing");
+    EXPECT_EQ(field("NUM"), "42");
+
+    // A repeated header replaces the next placeholder.
+    lg2::info("{A}{{A}}", "A", 1, "A", 2);
+    EXPECT_EQ(field("MESSAGE"), "1{2}");
+    EXPECT_EQ(journalFields.count("A"), 2);
+}
+
+TEST(LG2Logger, Formatting)
+{
+    lg2::info("Values", "HEX8", lg2::hex | lg2::field8, 0x1, "HEX16",
+              lg2::hex | lg2::field16, 0x2, "HEX32", lg2::hex | lg2::field32,
+              0x3, "HEX64", lg2::hex | lg2::field64, 0x4, "HEX", lg2::hex,
+              0xabc, "BIN8", lg2::bin | lg2::field8, 5, "BIN", lg2::bin, 1,
+              "NEG", -12, "NEGHEX", lg2::hex | lg2::field8, int8_t{-1}, "BOOL",
+              true, "FLOAT", 1.5, "HUGE", 1e100);
+
+    EXPECT_EQ(field("HEX8"), "0x01");
+    EXPECT_EQ(field("HEX16"), "0x0002");
+    EXPECT_EQ(field("HEX32"), "0x00000003");
+    EXPECT_EQ(field("HEX64"), "0x0000000000000004");
+    EXPECT_EQ(field("HEX"), "0xabc");
+    EXPECT_EQ(field("BIN8"), "0b00000101");
+    EXPECT_EQ(field("BIN"), "0b" + std::string(63, '0') + "1");
+    EXPECT_EQ(field("NEG"), "-12");
+    EXPECT_EQ(field("NEGHEX"), "0xffffffffffffffff");
+    EXPECT_EQ(field("BOOL"), "True");
+    EXPECT_EQ(field("FLOAT"), std::to_string(1.5));
+    EXPECT_EQ(field("HUGE"), std::to_string(1e100));
+}
+
+TEST(LG2Logger, LargeEntries)
+{
+    // Values and headers that don't fit in the inline storage.
+    std::string big(10000, 'x');
+    lg2::info("{BIG} {H30}", "BIG", big, "H1", 1, "H2", 2, "H3", 3, "H4", 4,
+              "H5", 5, "H6", 6, "H7", 7, "H8", 8, "H9", 9, "H10", 10, "H11", 11,
+              "H12", 12, "H13", 13, "H14", 14, "H15", 15, "H16", 16, "H17", 17,
+              "H18", 18, "H19", 19, "H20", 20, "H21", 21, "H22", 22, "H23", 23,
+              "H24", 24, "H25", 25, "H26", 26, "H27", 27, "H28", 28, "H29", 29,
+              "H30", 30);
+
+    EXPECT_EQ(field("MESSAGE"), big + " 30");
+    EXPECT_EQ(field("BIG"), big);
+    for (int i = 1; i <= 30; i++)
+    {
+        EXPECT_EQ(field("H" + std::to_string(i)), std::to_string(i));
+    }
+    EXPECT_EQ(field("PRIORITY"), "6");
+}
+
+TEST(LG2Logger, SetLevel)
+{
+    Counted counted;
+
+    lg2::set_level(lg2::level::warning);
+    journalFields.clear();
+
+    lg2::info("Info", "VALUE", counted);
+    EXPECT_TRUE(journalFields.empty());
+    EXPECT_EQ(counted.conversions, 0);
+
+    lg2::warning("Warning", "VALUE", counted);
+    EXPECT_EQ(field("MESSAGE"), "Warning");
+    EXPECT_EQ(field("VALUE"), "counted");
+    EXPECT_EQ(counted.conversions, 1);
+
+    lg2::set_level(lg2::level::debug);
+    lg2::info("Info", "VALUE", counted);
+    EXPECT_EQ(field("MESSAGE"), "Info");
+    EXPECT_EQ(counted.conversions, 2);
+}
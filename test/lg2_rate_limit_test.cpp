@@ -0,0 +1,76 @@
+#include <systemd/sd-journal.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+// Allow 3 entries per callsite every 200ms, set before the first log.
+static const int rateLimitEnabled = setenv("LG2_RATE_LIMIT", "3/0.2", 1);
+
+// The entries sent to the journal, captured by overriding the libsystemd
+// function.
+static std::vector<std::map<std::string, std::string>> entries;
+
+extern "C" int sd_journal_sendv(const struct iovec* iov, int n)
+{
+    auto& entry = entries.emplace_back();
+    for (int i = 0; i < n; i++)
+    {
+        std::string field{static_cast<const char*>(iov[i].iov_base),
+                          iov[i].iov_len};
+        auto pos = field.find('=');
+        entry.emplace(field.substr(0, pos), field.substr(pos + 1));
+    }
+    return 0;
+}
+
+static void flappingSensor(int reading)
+{
+    lg2::error("Sensor reading {VALUE} out of range", "VALUE", reading);
+}
+
+TEST(LG2RateLimit, PerCallsite)
+{
+    ASSERT_EQ(rateLimitEnabled, 0);
+
+    // Wait for the start of a window so this doesn't span two of them.
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    auto window = std::chrono::milliseconds(200);
+    std::this_thread::sleep_for(window - (now % window));
+
+    for (int i = 0; i < 10; i++)
+    {
+        flappingSensor(i);
+    }
+
+    // Another callsite has its own limit.
+    lg2::info("Other callsite");
+
+    ASSERT_EQ(entries.size(), 4);
+    for (int i = 0; i < 3; i++)
+    {
+        EXPECT_EQ(entries[i]["MESSAGE"],
+                  "Sensor reading " + std::to_string(i) + " out of range");
+    }
+    EXPECT_EQ(entries[3]["MESSAGE"], "Other callsite");
+
+    // The first entry in the next window is preceded by a summary.
+    std::this_thread::sleep_for(window);
+    entries.clear();
+    flappingSensor(42);
+
+    ASSERT_EQ(entries.size(), 2);
+    EXPECT_EQ(entries[0]["SUPPRESSED_COUNT"], "7");
+    EXPECT_EQ(entries[0]["PRIORITY"], "3");
+    EXPECT_EQ(entries[0]["MESSAGE"],
+              "7 entries from this location were suppressed by rate limiting");
+    EXPECT_EQ(entries[0]["CODE_LINE"], entries[1]["CODE_LINE"]);
+    EXPECT_EQ(entries[1]["MESSAGE"], "Sensor reading 42 out of range");
+}
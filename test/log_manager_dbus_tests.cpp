@@ -9,6 +9,7 @@
 #include <xyz/openbmc_project/Logging/Entry/client.hpp>
 #include <xyz/openbmc_project/Logging/event.hpp>
 
+#include <chrono>
 #include <thread>
 
 #include <gmock/gmock.h>
@@ -160,6 +161,61 @@ TEST_F(TestLogManagerDbus, CallCommitSync)
     }
 }
 
+// Commit several events without waiting for replies, and verify that they
+// are all created.
+TEST_F(TestLogManagerDbus, CallCommitNoReply)
+{
+    auto entries = data->iMgr.entries.size();
+
+    for (size_t i = 0; i < 5; i++)
+    {
+        lg2::commit_noreply(LoggingCleared("NUMBER_OF_LOGS", i));
+    }
+
+    if constexpr (LG2_COMMIT_DBUS)
+    {
+        // Without any synchronous call to drive the connection, the
+        // entries must still show up.
+        for (size_t i = 0;
+             (i < 500) && (data->iMgr.entries.size() < entries + 5); i++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        EXPECT_EQ(data->iMgr.entries.size(), entries + 5);
+    }
+}
+
+// Commit several events with one call, and verify that each gets its own
+// entry.
+TEST_F(TestLogManagerDbus, CallCommitBatch)
+{
+    auto entries = data->iMgr.entries.size();
+
+    LoggingCleared first("NUMBER_OF_LOGS", 7);
+    LoggingCleared second("NUMBER_OF_LOGS", 8);
+    auto logPaths = lg2::commit_batch({first, second});
+
+    ASSERT_EQ(logPaths.size(), 2);
+
+    if constexpr (LG2_COMMIT_DBUS)
+    {
+        EXPECT_EQ(data->iMgr.entries.size(), entries + 2);
+
+        ASSERT_FALSE(logPaths[0].str.empty());
+        ASSERT_FALSE(logPaths[1].str.empty());
+        EXPECT_NE(logPaths[0], logPaths[1]);
+
+        auto id = std::stoul(logPaths[1].filename());
+        ASSERT_TRUE(data->iMgr.entries.contains(id));
+        EXPECT_EQ(data->iMgr.entries.at(id)->additionalData().at(
+                      "NUMBER_OF_LOGS"),
+                  "8");
+        EXPECT_TRUE(std::filesystem::exists(
+            std::filesystem::path(paths::error()) / std::to_string(id)));
+    }
+}
+
 // Call the asynchronous version of the commit function and verify that the
 // metadata is saved correctly.
 TEST_F(TestLogManagerDbus, CallCommitAsync)
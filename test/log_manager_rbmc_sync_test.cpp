@@ -9,6 +9,7 @@
 #include <sdeventplus/event.hpp>
 
 #include <filesystem>
+#include <fstream>
 #include <memory>
 #include <string>
 
@@ -162,4 +163,43 @@ TEST_F(LogManagerRedundantBMCSyncTest, EventLogDelete)
     EXPECT_FALSE(manager->entries.contains(entryId));
 }
 
+TEST_F(LogManagerRedundantBMCSyncTest, EventLogOwnWrite)
+{
+    manager->setupErrorFileWatch();
+
+    auto tempEntryPath = writeTempSerializedEntry(Entry::Level::Informational,
+                                                  "first message", false);
+
+    fs::rename(tempEntryPath, repoEntryPath);
+    processPendingEvents();
+
+    ASSERT_TRUE(manager->entries.contains(entryId));
+
+    // This process persisting the entry itself, including the write and
+    // removal of a temporary file, doesn't make it reread the file.
+    {
+        Entry entry{bus,
+                    std::string(OBJ_ENTRY) + "/" + std::to_string(entryId),
+                    entryId,
+                    100,
+                    Entry::Level::Error,
+                    "own message",
+                    {},
+                    {},
+                    "fw",
+                    repoEntryPath.string(),
+                    *manager};
+        serialize(entry);
+    }
+
+    auto tmpPath = paths::error() / ("." + std::to_string(entryId) + ".tmp");
+    std::ofstream{tmpPath} << "garbage";
+    fs::remove(tmpPath);
+    processPendingEvents();
+
+    ASSERT_TRUE(manager->entries.contains(entryId));
+    EXPECT_EQ(manager->entries.at(entryId)->message(), "first message");
+    EXPECT_FALSE(isOwnRename(repoEntryPath));
+}
+
 } // namespace phosphor::logging::test
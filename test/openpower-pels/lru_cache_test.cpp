@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "extensions/openpower-pels/lru_cache.hpp"
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+using namespace openpower::pels;
+
+TEST(LRUCacheTest, GetInsertTest)
+{
+    LRUCache<std::string, int> cache{3};
+
+    EXPECT_FALSE(cache.get("a"));
+
+    cache.insert("a", 1);
+    cache.insert("b", 2);
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_EQ(cache.get("a"), 1);
+    EXPECT_EQ(cache.get("b"), 2);
+
+    // Replace one
+    cache.insert("a", 3);
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_EQ(cache.get("a"), 3);
+
+    EXPECT_TRUE(cache.erase("a"));
+    EXPECT_FALSE(cache.erase("a"));
+    EXPECT_FALSE(cache.get("a"));
+
+    EXPECT_EQ(cache.hits(), 3);
+    EXPECT_EQ(cache.misses(), 2);
+
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_FALSE(cache.get("b"));
+    EXPECT_EQ(cache.misses(), 3);
+}
+
+TEST(LRUCacheTest, EvictTest)
+{
+    LRUCache<int, std::string> cache{3};
+
+    cache.insert(1, "one");
+    cache.insert(2, "two");
+    cache.insert(3, "three");
+
+    // Use 1 so that 2 is the least recently used
+    EXPECT_EQ(cache.get(1), "one");
+
+    cache.insert(4, "four");
+    EXPECT_EQ(cache.size(), 3);
+    EXPECT_FALSE(cache.get(2));
+    EXPECT_EQ(cache.get(1), "one");
+    EXPECT_EQ(cache.get(3), "three");
+    EXPECT_EQ(cache.get(4), "four");
+
+    // Now 1 is the oldest
+    cache.insert(5, "five");
+    EXPECT_FALSE(cache.get(1));
+    EXPECT_EQ(cache.get(5), "five");
+
+    // Nothing is kept with no capacity
+    LRUCache<int, int> empty{0};
+    empty.insert(1, 1);
+    EXPECT_EQ(empty.size(), 0);
+    EXPECT_FALSE(empty.get(1));
+}
@@ -156,7 +156,7 @@ TEST_F(ManagerTest, TestCreateWithPEL)
     EXPECT_TRUE(pelPathInRepo);
 
     // Now remove it based on its OpenBMC event log ID
-    manager.erase(42);
+    manager.erase({42});
 
     pelPathInRepo = findAnyPELInRepo();
 
@@ -302,7 +302,7 @@ TEST_F(ManagerTest, TestCreateWithMessageRegistry)
               "SVCDOCS\n");
 
     // Remove it
-    manager.erase(33);
+    manager.erase({33});
     pelFile = findAnyPELInRepo();
     EXPECT_FALSE(pelFile);
 
@@ -1176,7 +1176,7 @@ TEST_F(ManagerTest, TestFruPlug)
     mockIface->fruPresent("U1234-A3");
     checkDeconfigured(false);
 
-    manager.erase(42);
+    manager.erase({42});
 
     // Create it again and replace a FRU not in the callout list.
     // Deconfig flag should stay on.
@@ -1314,7 +1314,7 @@ TEST_F(ManagerTest, TestPELDeleteWithoutHWIsolation)
         // is false.
         EXPECT_FALSE(manager.isDeleteProhibited(42));
     }
-    manager.erase(42);
+    manager.erase({42});
     EXPECT_FALSE(findAnyPELInRepo());
 
     auto [fd, calloutFile] = createHWIsolatedCalloutFile();
@@ -1338,7 +1338,7 @@ TEST_F(ManagerTest, TestPELDeleteWithoutHWIsolation)
         // array list then `isDeleteProhibited` returns false
         EXPECT_FALSE(manager.isDeleteProhibited(42));
     }
-    manager.erase(42);
+    manager.erase({42});
 }
 
 TEST_F(ManagerTest, TestPELDeleteWithHWIsolation)
@@ -1418,7 +1418,7 @@ TEST_F(ManagerTest, TestPELDeleteWithHWIsolation)
     // `isDeleteProhibited` returning true as expected.
     EXPECT_TRUE(pel.getGuardFlag());
     EXPECT_TRUE(manager.isDeleteProhibited(42));
-    manager.erase(42);
+    manager.erase({42});
 }
 
 // Test that the PELs get created with the BMC position from the obmcLogID
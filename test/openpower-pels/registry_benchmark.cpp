@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "extensions/openpower-pels/registry.hpp"
+#include "extensions/openpower-pels/registry_image.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+using namespace openpower::pels::message;
+namespace fs = std::filesystem;
+
+namespace
+{
+
+// A copy of the message registry JSON, and optionally of the image
+// generated from it, removed when done.
+struct TestRegistry
+{
+    explicit TestRegistry(bool useImage)
+    {
+        char path[] = "/tmp/regbenchXXXXXX";
+        dir = mkdtemp(path);
+
+        jsonFile = dir / registryFileName;
+        fs::copy_file(REGISTRY_JSON, jsonFile);
+
+        // The image is only used when it's newer than the JSON.
+        if (useImage)
+        {
+            fs::copy_file(REGISTRY_IMAGE, fs::path{jsonFile}.replace_extension(
+                                              registryImageExtension));
+        }
+
+        std::ifstream file{REGISTRY_JSON};
+        auto registryJSON = nlohmann::json::parse(file);
+        for (const auto& pel : registryJSON["PELs"])
+        {
+            names.push_back(pel["Name"].get<std::string>());
+        }
+    }
+
+    ~TestRegistry()
+    {
+        fs::remove_all(dir);
+    }
+
+    fs::path dir;
+    fs::path jsonFile;
+    std::vector<std::string> names;
+};
+
+} // namespace
+
+// The first lookup, which loads the registry, like the first PEL created
+// after the daemon starts.
+static void BM_FirstLookup(benchmark::State& state)
+{
+    TestRegistry test{state.range(0) != 0};
+    size_t i = 0;
+
+    for (auto _ : state)
+    {
+        Registry registry{test.jsonFile};
+        auto entry = registry.lookup(test.names[i++ % test.names.size()],
+                                     LookupType::name);
+        benchmark::DoNotOptimize(entry);
+    }
+}
+BENCHMARK(BM_FirstLookup)->ArgName("image")->Arg(0)->Arg(1);
+
+// Lookups once the registry is loaded, which still check if the file
+// changed, as is done for each PEL created.
+static void BM_Lookup(benchmark::State& state)
+{
+    TestRegistry test{state.range(0) != 0};
+    Registry registry{test.jsonFile};
+    size_t i = 0;
+
+    for (auto _ : state)
+    {
+        auto entry = registry.lookup(test.names[i++ % test.names.size()],
+                                     LookupType::name);
+        benchmark::DoNotOptimize(entry);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Lookup)->ArgName("image")->Arg(0)->Arg(1);
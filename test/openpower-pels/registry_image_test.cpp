@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: Apache-2.0
+// SPDX-FileCopyrightText: Copyright 2026 IBM Corporation
+
+#include "extensions/openpower-pels/registry.hpp"
+#include "extensions/openpower-pels/registry_image.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+#include <gtest/gtest.h>
+
+using namespace openpower::pels::message;
+namespace fs = std::filesystem;
+
+class RegistryImageTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char path[] = "/tmp/regimageXXXXXX";
+        dir = mkdtemp(path);
+
+        std::ifstream file{REGISTRY_JSON};
+        registryJSON = nlohmann::json::parse(file);
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(dir);
+    }
+
+    fs::path dir;
+    nlohmann::json registryJSON;
+};
+
+// Every entry in the JSON can be found in the image by name and
+// reason code.
+TEST_F(RegistryImageTest, TestFindAll)
+{
+    RegistryImage image{REGISTRY_IMAGE};
+
+    const auto& pels = registryJSON["PELs"];
+    ASSERT_EQ(image.size(), pels.size());
+
+    for (const auto& pel : pels)
+    {
+        auto json = image.findByName(pel["Name"].get<std::string>());
+        ASSERT_TRUE(json);
+        EXPECT_EQ(nlohmann::json::parse(*json), pel);
+
+        json = image.findByReasonCode(
+            pel["SRC"]["ReasonCode"].get<std::string>());
+        ASSERT_TRUE(json);
+        EXPECT_EQ(nlohmann::json::parse(*json), pel);
+    }
+
+    EXPECT_FALSE(image.findByName("foo"));
+    EXPECT_FALSE(image.findByName(""));
+    EXPECT_FALSE(image.findByReasonCode("0xFFFF"));
+}
+
+// Registry lookups return the same entries from the image as from the JSON.
+TEST_F(RegistryImageTest, TestRegistryUsesImage)
+{
+    auto jsonFile = dir / registryFileName;
+    fs::copy_file(REGISTRY_JSON, jsonFile);
+    Registry jsonRegistry{jsonFile};
+
+    // Looking up the first time loads the JSON, and with toCache set
+    // it won't switch to the image after it's added.
+    ASSERT_TRUE(jsonRegistry.lookup(
+        registryJSON["PELs"][0]["Name"].get<std::string>(), LookupType::name,
+        true));
+
+    // Now add the image, which is newer than the JSON.
+    fs::copy_file(REGISTRY_IMAGE,
+                  fs::path{jsonFile}.replace_extension(registryImageExtension));
+    Registry imageRegistry{jsonFile};
+
+    for (const auto& pel : registryJSON["PELs"])
+    {
+        auto name = pel["Name"].get<std::string>();
+        auto fromJSON = jsonRegistry.lookup(name, LookupType::name, true);
+        auto fromImage = imageRegistry.lookup(name, LookupType::name);
+
+        ASSERT_TRUE(fromJSON);
+        ASSERT_TRUE(fromImage);
+        EXPECT_EQ(fromImage->name, fromJSON->name);
+        EXPECT_EQ(fromImage->subsystem, fromJSON->subsystem);
+        EXPECT_EQ(fromImage->actionFlags, fromJSON->actionFlags);
+        EXPECT_EQ(fromImage->componentID, fromJSON->componentID);
+        EXPECT_EQ(fromImage->src.reasonCode, fromJSON->src.reasonCode);
+        EXPECT_EQ(fromImage->src.type, fromJSON->src.type);
+        EXPECT_EQ(fromImage->doc.message, fromJSON->doc.message);
+        EXPECT_EQ(fromImage->callouts, fromJSON->callouts);
+
+        auto rc = pel["SRC"]["ReasonCode"].get<std::string>();
+        fromImage = imageRegistry.lookup(rc, LookupType::reasonCode);
+        ASSERT_TRUE(fromImage);
+        EXPECT_EQ(fromImage->name, name);
+    }
+
+    EXPECT_FALSE(imageRegistry.lookup("foo", LookupType::name));
+}
+
+// A bad image falls back to the JSON.
+TEST_F(RegistryImageTest, TestBadImage)
+{
+    auto jsonFile = dir / registryFileName;
+    fs::copy_file(REGISTRY_JSON, jsonFile);
+
+    auto imageFile =
+        fs::path{jsonFile}.replace_extension(registryImageExtension);
+    {
+        std::ofstream image{imageFile};
+        image << "PELREG but not really an image";
+    }
+
+    EXPECT_THROW(RegistryImage{imageFile}, std::runtime_error);
+
+    Registry registry{jsonFile};
+    auto name = registryJSON["PELs"][0]["Name"].get<std::string>();
+    auto entry = registry.lookup(name, LookupType::name);
+    ASSERT_TRUE(entry);
+    EXPECT_EQ(entry->name, name);
+}
@@ -1189,3 +1189,52 @@ TEST_F(RegistryTest, TestJournalSectionCapture)
     EXPECT_EQ(acl[1].syslogID, "test2");
     EXPECT_EQ(acl[1].numLines, 6);
 }
+
+// Test that the registry is reloaded when the file changes
+TEST_F(RegistryTest, TestReloadOnChange)
+{
+    auto path = RegistryTest::writeData(registryData);
+    Registry registry{path};
+
+    ASSERT_TRUE(registry.lookup("0x2030", LookupType::reasonCode));
+
+    // Lookups from the loaded copy
+    for (size_t i = 0; i < 100; i++)
+    {
+        auto entry = registry.lookup("xyz.openbmc_project.Power.Fault",
+                                     LookupType::name);
+        ASSERT_TRUE(entry);
+        EXPECT_EQ(entry->src.reasonCode, 0x2030);
+    }
+
+    const auto newData = R"(
+{
+    "PELs":
+    [
+        {
+            "Name": "xyz.openbmc_project.New.Error",
+            "Subsystem": "power_supply",
+            "SRC":
+            {
+                "ReasonCode": "0x2031"
+            },
+            "Documentation":
+            {
+                "Description": "A new error",
+                "Message": "A new error"
+            }
+        }
+    ]
+}
+)";
+
+    RegistryTest::writeData(newData);
+    fs::last_write_time(path, fs::last_write_time(path) + std::chrono::hours(1));
+
+    EXPECT_FALSE(registry.lookup("xyz.openbmc_project.Power.Fault",
+                                 LookupType::name));
+
+    auto entry = registry.lookup("0x2031", LookupType::reasonCode);
+    ASSERT_TRUE(entry);
+    EXPECT_EQ(entry->name, "xyz.openbmc_project.New.Error");
+}
@@ -0,0 +1,186 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "extensions/openpower-pels/paths.hpp"
+#include "extensions/openpower-pels/repository.hpp"
+#include "pel_utils.hpp"
+
+#include <filesystem>
+
+#include <benchmark/benchmark.h>
+
+using namespace openpower::pels;
+namespace fs = std::filesystem;
+
+namespace
+{
+
+// A repository holding a number of PELs, removed when done.
+struct TestRepo
+{
+    explicit TestRepo(size_t count, size_t repoSize = getPELRepoSize(),
+                      size_t maxNumPELs = getMaxNumPELs()) :
+        path(getPELRepoPath()), repo(path, repoSize, maxNumPELs)
+    {
+        add(count);
+    }
+
+    ~TestRepo()
+    {
+        fs::remove_all(path);
+    }
+
+    // Adds PELs, sharing a single sync.
+    void add(size_t count)
+    {
+        repo.setGroupCommit(true);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            auto data = pelDataFactory(TestPELType::pelSimple);
+            auto pel = std::make_unique<PEL>(data, nextOBMCID++);
+            pel->assignID();
+            ids.push_back(pel->id());
+            repo.add(pel);
+        }
+
+        repo.setGroupCommit(false);
+    }
+
+    fs::path path;
+    Repository repo;
+    std::vector<uint32_t> ids;
+    uint32_t nextOBMCID = 1;
+};
+
+} // namespace
+
+// A host sending and acking PELs, which patches the states in place.
+static void BM_SetHostTransState(benchmark::State& state)
+{
+    TestRepo test{100};
+    size_t i = 0;
+
+    for (auto _ : state)
+    {
+        auto id = test.ids[i++ % test.ids.size()];
+        test.repo.setPELHostTransState(id, TransmissionState::sent);
+        test.repo.setPELHostTransState(id, TransmissionState::acked);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SetHostTransState);
+
+// The same state changes, done by reading and rewriting the whole PEL.
+static void BM_UpdatePELHostTransState(benchmark::State& state)
+{
+    TestRepo test{100};
+    size_t i = 0;
+
+    for (auto _ : state)
+    {
+        auto id = test.ids[i++ % test.ids.size()];
+        auto path = test.repo.getPELAttributes(Repository::LogID{
+                                                   Repository::LogID::Pel{id}})
+                        ->get()
+                        .path;
+
+        for (auto transState :
+             {TransmissionState::sent, TransmissionState::acked})
+        {
+            test.repo.updatePEL(path, [transState](PEL& pel) {
+                pel.setHostTransmissionState(transState);
+                return true;
+            });
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UpdatePELHostTransState);
+
+// Adding PELs, syncing each one (0) or using group commit (1) with a sync
+// every 16 PELs.
+static void BM_AddPEL(benchmark::State& state)
+{
+    TestRepo test{0};
+    bool groupCommit = state.range(0);
+    test.repo.setGroupCommit(groupCommit);
+    uint32_t obmcID = 1;
+
+    for (auto _ : state)
+    {
+        auto data = pelDataFactory(TestPELType::pelSimple);
+        auto pel = std::make_unique<PEL>(data, obmcID++);
+        pel->assignID();
+        test.repo.add(pel);
+
+        if (groupCommit && (obmcID % 16 == 0))
+        {
+            test.repo.sync();
+        }
+
+        // Keep the repository from filling up.
+        if (test.repo.sizeWarning())
+        {
+            state.PauseTiming();
+            test.repo.prune({});
+            state.ResumeTiming();
+        }
+    }
+
+    test.repo.sync();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AddPEL)->Arg(0)->Arg(1);
+
+// Looking PELs up by their OpenBMC log IDs in a repository of 10000.
+static void BM_FindPELByOBMCID(benchmark::State& state)
+{
+    constexpr size_t numPELs = 10000;
+    TestRepo test{numPELs, numPELs * 8192, numPELs};
+    uint32_t obmcID = 1;
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(test.repo.hasPEL(
+            Repository::LogID{Repository::LogID::Obmc{obmcID}}));
+        obmcID = (obmcID % numPELs) + 1;
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FindPELByOBMCID);
+
+// Pruning a repository that has filled up with the sizes used on a
+// real system.
+static void BM_PruneFullRepo(benchmark::State& state)
+{
+    TestRepo test{0, 20 * 1024 * 1024, 3000};
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        while (!test.repo.sizeWarning())
+        {
+            test.add(100);
+        }
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(test.repo.prune({}));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PruneFullRepo);
+
+int main(int argc, char** argv)
+{
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    // Remove the PEL ID file the PELs were assigned IDs from.
+    fs::remove_all(fs::path{getPELIDFile()}.parent_path());
+    return 0;
+}
@@ -7,7 +7,9 @@
 
 #include <ext/stdio_filebuf.h>
 
+#include <array>
 #include <filesystem>
+#include <fstream>
 
 #include <gtest/gtest.h>
 
@@ -174,6 +176,140 @@ TEST_F(RepositoryTest, RestoreTest)
     }
 }
 
+// Test that the attributes restored from only the PEL headers
+// match the ones from when the PEL was added.
+TEST_F(RepositoryTest, RestoreAttributesTest)
+{
+    using pelID = Repository::LogID::Pel;
+
+    std::vector<uint32_t> ids;
+    std::map<uint32_t, Repository::PELAttributes> addedAttributes;
+
+    {
+        Repository repo{repoPath};
+
+        for (uint32_t i = 1; i <= 5; i++)
+        {
+            auto data = pelDataFactory(TestPELType::pelSimple);
+            auto pel = std::make_unique<PEL>(data, i);
+            pel->assignID();
+            repo.add(pel);
+            ids.push_back(pel->id());
+        }
+
+        // The host state of sent gets reset on restore
+        repo.setPELHostTransState(ids[0], TransmissionState::sent);
+        repo.setPELHMCTransState(ids[1], TransmissionState::acked);
+
+        for (auto id : ids)
+        {
+            auto attributes = repo.getPELAttributes(Repository::LogID{pelID{id}});
+            ASSERT_TRUE(attributes);
+            addedAttributes.emplace(id, attributes->get());
+        }
+    }
+
+    Repository repo{repoPath};
+
+    for (auto id : ids)
+    {
+        auto attributes = repo.getPELAttributes(Repository::LogID{pelID{id}});
+        ASSERT_TRUE(attributes);
+
+        const auto& restored = attributes->get();
+        const auto& added = addedAttributes.at(id);
+
+        EXPECT_EQ(restored.path, added.path);
+        EXPECT_EQ(restored.sizeOnDisk, added.sizeOnDisk);
+        EXPECT_EQ(restored.creator, added.creator);
+        EXPECT_EQ(restored.subsystem, added.subsystem);
+        EXPECT_EQ(restored.severity, added.severity);
+        EXPECT_EQ(restored.actionFlags, added.actionFlags);
+        EXPECT_EQ(restored.hmcState, added.hmcState);
+        EXPECT_EQ(restored.plid, added.plid);
+        EXPECT_EQ(restored.deconfig, added.deconfig);
+        EXPECT_EQ(restored.guard, added.guard);
+        EXPECT_EQ(restored.creationTime, added.creationTime);
+
+        if (id == ids[0])
+        {
+            EXPECT_EQ(restored.hostState, TransmissionState::newPEL);
+        }
+        else
+        {
+            EXPECT_EQ(restored.hostState, added.hostState);
+        }
+    }
+
+    EXPECT_EQ(repo.getLogID(Repository::LogID{pelID{ids[2]}})->obmcID.id, 3);
+
+    // The reset host state was also written to the file
+    auto data = repo.getPELData(Repository::LogID{pelID{ids[0]}});
+    ASSERT_TRUE(data);
+    PEL pel{*data};
+    EXPECT_EQ(pel.hostTransmissionState(), TransmissionState::newPEL);
+}
+
+// Test that PELs whose section headers don't check out aren't restored
+TEST_F(RepositoryTest, RestoreBadSectionsTest)
+{
+    auto data = pelDataFactory(TestPELType::pelSimple);
+    PEL pel{data};
+    auto logPath = repoPath / "logs";
+    fs::create_directories(logPath);
+
+    auto writePEL = [&logPath](const std::string& name,
+                               const std::vector<uint8_t>& pelData) {
+        std::ofstream file{logPath / name, std::ios::binary};
+        file.write(reinterpret_cast<const char*>(pelData.data()),
+                   pelData.size());
+    };
+
+    // Find the first section after the User Header
+    Stream stream{data};
+    SectionHeader header;
+    stream >> header;
+    size_t offset = header.size;
+    stream.offset(offset);
+    stream >> header;
+    offset += header.size;
+
+    writePEL("good", data);
+
+    // Extra data after the last section
+    auto extra = data;
+    extra.resize(extra.size() + 8);
+    writePEL("extra", extra);
+
+    // The last section runs past the end of the file
+    auto truncated = data;
+    truncated.resize(truncated.size() - 4);
+    writePEL("truncated", truncated);
+
+    // A section ID that isn't two letters
+    auto badID = data;
+    badID[offset] = 0;
+    badID[offset + 1] = 0;
+    writePEL("badid", badID);
+
+    // A section size smaller than the section header
+    auto badSize = data;
+    badSize[offset + 2] = 0;
+    badSize[offset + 3] = 4;
+    writePEL("badsize", badSize);
+
+    Repository repo{repoPath};
+
+    EXPECT_TRUE(
+        repo.hasPEL(Repository::LogID{Repository::LogID::Pel{pel.id()}}));
+    EXPECT_TRUE(fs::exists(logPath / "good"));
+
+    for (const auto& name : {"extra", "truncated", "badid", "badsize"})
+    {
+        EXPECT_FALSE(fs::exists(logPath / name)) << name;
+    }
+}
+
 TEST_F(RepositoryTest, TestGetPELData)
 {
     using ID = Repository::LogID;
@@ -809,6 +945,28 @@ TEST_F(RepositoryTest, TestPruneTooManyPELs)
     EXPECT_EQ(IDs[2], 500 + 3);
 }
 
+// Test that when there are too many PELs the oldest ones are
+// removed first, even when they are in different categories.
+TEST_F(RepositoryTest, TestPruneTooManyPELsMixed)
+{
+    std::vector<uint32_t> id;
+    Repository repo{repoPath, 4096 * 100, 10};
+
+    // Cycle through BMC/non-BMC and informational/predictive PELs
+    for (uint32_t i = 1; i <= 11; i++)
+    {
+        char creator = (i % 4 < 2) ? 'O' : 'H';
+        uint8_t sev = (i % 2) ? 0x00 : 0x20;
+        auto data = pelFactory(i, creator, sev, 0x8800, 500);
+        auto pel = std::make_unique<PEL>(data);
+        repo.add(pel);
+    }
+
+    auto IDs = repo.prune(id);
+    EXPECT_EQ(repo.getSizeStats().total, 4096 * 8);
+    EXPECT_EQ(IDs, (std::vector<uint32_t>{500 + 1, 500 + 2, 500 + 3}));
+}
+
 // Test the sizeWarning function
 TEST_F(RepositoryTest, TestSizeWarning)
 {
@@ -981,6 +1139,40 @@ TEST_F(RepositoryTest, GetLogIDFoundTC)
     EXPECT_EQ(logID->pelID.id, pel->id());
 }
 
+// With two PELs for the same OpenBMC log ID, the other one is found
+// after one is removed.
+TEST_F(RepositoryTest, GetLogIDDuplicateTC)
+{
+    using pelID = Repository::LogID::Pel;
+    using obmcID = Repository::LogID::Obmc;
+
+    Repository repo{repoPath};
+    std::vector<uint32_t> ids;
+
+    for (int i = 0; i < 2; i++)
+    {
+        auto data = pelDataFactory(TestPELType::pelSimple);
+        auto pel = std::make_unique<PEL>(data, 5);
+        pel->assignID();
+        ids.push_back(pel->id());
+        repo.add(pel);
+    }
+
+    Repository::LogID idWithObmcLogId{obmcID(5)};
+    auto logID = repo.getLogID(idWithObmcLogId);
+    ASSERT_TRUE(logID.has_value());
+    EXPECT_EQ(logID->pelID.id, std::min(ids[0], ids[1]));
+
+    repo.remove(*logID);
+
+    logID = repo.getLogID(idWithObmcLogId);
+    ASSERT_TRUE(logID.has_value());
+    EXPECT_EQ(logID->pelID.id, std::max(ids[0], ids[1]));
+
+    repo.remove(Repository::LogID{pelID{logID->pelID.id}});
+    EXPECT_FALSE(repo.getLogID(idWithObmcLogId));
+}
+
 TEST_F(RepositoryTest, GetLogIDNotFoundTC)
 {
     // Add and Check the created LogId
@@ -1004,6 +1196,63 @@ TEST_F(RepositoryTest, GetLogIDNotFoundTC)
     ASSERT_TRUE(!logID.has_value());
 }
 
+// Test looking up PELs by either ID as they are added and removed
+TEST_F(RepositoryTest, TestLookupByEitherID)
+{
+    using pelID = Repository::LogID::Pel;
+    using obmcID = Repository::LogID::Obmc;
+
+    Repository repo{repoPath};
+    std::vector<Repository::LogID> ids;
+
+    for (uint32_t i = 1; i <= 50; i++)
+    {
+        auto data = pelDataFactory(TestPELType::pelSimple);
+        auto pel = std::make_unique<PEL>(data, i + 100);
+        pel->assignID();
+        ids.emplace_back(pelID{pel->id()}, obmcID{pel->obmcLogID()});
+        repo.add(pel);
+    }
+
+    for (const auto& id : ids)
+    {
+        auto logID = repo.getLogID(Repository::LogID{id.obmcID});
+        ASSERT_TRUE(logID);
+        EXPECT_EQ(logID->pelID.id, id.pelID.id);
+
+        logID = repo.getLogID(Repository::LogID{id.pelID});
+        ASSERT_TRUE(logID);
+        EXPECT_EQ(logID->obmcID.id, id.obmcID.id);
+    }
+
+    // Remove every other one by OpenBMC ID
+    for (size_t i = 0; i < ids.size(); i += 2)
+    {
+        auto removedID = repo.remove(Repository::LogID{ids[i].obmcID});
+        ASSERT_TRUE(removedID);
+        EXPECT_EQ(removedID->pelID.id, ids[i].pelID.id);
+    }
+
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        bool present = (i % 2) != 0;
+        EXPECT_EQ(repo.hasPEL(Repository::LogID{ids[i].obmcID}), present);
+        EXPECT_EQ(repo.hasPEL(Repository::LogID{ids[i].pelID}), present);
+    }
+
+    // A new repo restored from the files has the same index
+    Repository restored{repoPath};
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        bool present = (i % 2) != 0;
+        EXPECT_EQ(restored.hasPEL(Repository::LogID{ids[i].obmcID}), present);
+    }
+
+    // An ID of 0 never matches
+    EXPECT_FALSE(repo.hasPEL(Repository::LogID{obmcID{0}}));
+    EXPECT_FALSE(repo.hasPEL(Repository::LogID{pelID{0}}));
+}
+
 // Test that OpenBMC log Id with hardware isolation entry is not removed.
 TEST_F(RepositoryTest, TestPruneWithIdHwIsoEntry)
 {
@@ -1043,3 +1292,405 @@ TEST_F(RepositoryTest, TestPruneWithIdHwIsoEntry)
     EXPECT_EQ(IDs[1], 500 + 3);
     EXPECT_EQ(IDs[2], 500 + 4);
 }
+
+// Prune a repository where the ack states and hardware isolation
+// entries change the order PELs are removed in.
+TEST_F(RepositoryTest, TestPruneLargeRepo)
+{
+    // The OpenBMC log ID is the PEL ID + 500.
+    std::vector<uint32_t> hwIsoIDs{500 + 1, 500 + 2};
+    Repository repo{repoPath, 4096 * 100, 200};
+
+    for (uint32_t i = 1; i <= 100; i++)
+    {
+        auto data = pelFactory(i, 'O', 0, 0x8800, 500);
+        auto pel = std::make_unique<PEL>(data);
+        repo.add(pel);
+    }
+
+    // HMC acked PELs get removed first, even though they're newest.
+    for (uint32_t i = 90; i < 100; i++)
+    {
+        repo.setPELHMCTransState(i, TransmissionState::acked);
+    }
+
+    // BMC info PELs can take up 15%, so 15 will be left.
+    auto IDs = repo.prune(hwIsoIDs);
+    EXPECT_EQ(repo.getSizeStats().bmcInfo, 4096 * 15);
+    ASSERT_EQ(IDs.size(), 85);
+
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        EXPECT_EQ(IDs[i], 500 + 90 + i);
+    }
+
+    // Then the oldest that don't have a hardware isolation entry.
+    for (uint32_t i = 10; i < IDs.size(); i++)
+    {
+        EXPECT_EQ(IDs[i], 500 + 3 + i - 10);
+    }
+
+    EXPECT_TRUE(repo.hasPEL(Repository::LogID{Repository::LogID::Pel{1}}));
+    EXPECT_TRUE(repo.hasPEL(Repository::LogID{Repository::LogID::Pel{2}}));
+    EXPECT_FALSE(repo.hasPEL(Repository::LogID{Repository::LogID::Pel{77}}));
+    EXPECT_TRUE(repo.hasPEL(Repository::LogID{Repository::LogID::Pel{78}}));
+    EXPECT_TRUE(repo.hasPEL(Repository::LogID{Repository::LogID::Pel{100}}));
+}
+
+// Test that the index file is used and kept up to date
+TEST_F(RepositoryTest, TestIndexFile)
+{
+    using pelID = Repository::LogID::Pel;
+    std::vector<uint32_t> ids;
+
+    {
+        Repository repo{repoPath};
+
+        for (uint32_t i = 1; i <= 4; i++)
+        {
+            auto data = pelDataFactory(TestPELType::pelSimple);
+            auto pel = std::make_unique<PEL>(data, i);
+            pel->assignID();
+            repo.add(pel);
+            ids.push_back(pel->id());
+        }
+
+        repo.remove(Repository::LogID{pelID{ids[3]}});
+        repo.setPELHMCTransState(ids[1], TransmissionState::acked);
+    }
+
+    EXPECT_TRUE(fs::exists(repoPath / "index"));
+
+    {
+        Repository repo{repoPath};
+        EXPECT_TRUE(repo.hasPEL(Repository::LogID{pelID{ids[0]}}));
+        EXPECT_TRUE(repo.hasPEL(Repository::LogID{pelID{ids[1]}}));
+        EXPECT_TRUE(repo.hasPEL(Repository::LogID{pelID{ids[2]}}));
+        EXPECT_FALSE(repo.hasPEL(Repository::LogID{pelID{ids[3]}}));
+
+        auto attributes =
+            repo.getPELAttributes(Repository::LogID{pelID{ids[1]}});
+        ASSERT_TRUE(attributes);
+        EXPECT_EQ(attributes->get().hmcState, TransmissionState::acked);
+        EXPECT_EQ(repo.getSizeStats().total, 3 * 4096);
+    }
+
+    // Remove a PEL file while the repository isn't running, so the
+    // index no longer matches.
+    {
+        Repository repo{repoPath};
+        auto attributes =
+            repo.getPELAttributes(Repository::LogID{pelID{ids[0]}});
+        ASSERT_TRUE(attributes);
+        fs::remove(attributes->get().path);
+    }
+
+    {
+        Repository repo{repoPath};
+        EXPECT_FALSE(repo.hasPEL(Repository::LogID{pelID{ids[0]}}));
+        EXPECT_TRUE(repo.hasPEL(Repository::LogID{pelID{ids[1]}}));
+        EXPECT_TRUE(repo.hasPEL(Repository::LogID{pelID{ids[2]}}));
+    }
+
+    // Corrupt the index, which will then be ignored.
+    {
+        std::ofstream index{repoPath / "index",
+                            std::ios::binary | std::ios::app};
+        index << "garbage";
+    }
+
+    {
+        Repository repo{repoPath};
+        EXPECT_TRUE(repo.hasPEL(Repository::LogID{pelID{ids[1]}}));
+        EXPECT_TRUE(repo.hasPEL(Repository::LogID{pelID{ids[2]}}));
+
+        auto attributes =
+            repo.getPELAttributes(Repository::LogID{pelID{ids[1]}});
+        ASSERT_TRUE(attributes);
+        EXPECT_EQ(attributes->get().hmcState, TransmissionState::acked);
+        EXPECT_EQ(repo.getSizeStats().total, 2 * 4096);
+    }
+}
+
+// Remove several PELs at once
+TEST_F(RepositoryTest, TestRemoveMany)
+{
+    using obmcID = Repository::LogID::Obmc;
+
+    {
+        Repository repo{repoPath};
+
+        for (uint32_t i = 1; i <= 10; i++)
+        {
+            auto data = pelDataFactory(TestPELType::pelSimple);
+            auto pel = std::make_unique<PEL>(data, i);
+            pel->assignID();
+            repo.add(pel);
+        }
+
+        std::vector<Repository::LogID> ids;
+        for (uint32_t i = 1; i <= 10; i += 2)
+        {
+            ids.emplace_back(obmcID{i});
+        }
+
+        // One that doesn't exist
+        ids.emplace_back(obmcID{42});
+
+        auto removed = repo.remove(ids);
+        ASSERT_EQ(removed.size(), 5);
+        for (const auto& id : removed)
+        {
+            EXPECT_NE(id.pelID.id, 0);
+            EXPECT_EQ(id.obmcID.id % 2, 1);
+        }
+
+        EXPECT_EQ(repo.getSizeStats().total, 5 * 4096);
+    }
+
+    {
+        // The index reflects the removes.
+        Repository repo{repoPath};
+        for (uint32_t i = 1; i <= 10; i++)
+        {
+            EXPECT_EQ(repo.hasPEL(Repository::LogID{obmcID{i}}), i % 2 == 0);
+        }
+
+        // Removing fewer than are left appends to the index instead
+        // of rewriting it.
+        auto indexSize = fs::file_size(repoPath / "index");
+        std::vector<Repository::LogID> ids{Repository::LogID{obmcID{2}}};
+        auto removed = repo.remove(ids);
+        ASSERT_EQ(removed.size(), 1);
+        EXPECT_GT(fs::file_size(repoPath / "index"), indexSize);
+    }
+
+    Repository repo{repoPath};
+    EXPECT_FALSE(repo.hasPEL(Repository::LogID{obmcID{2}}));
+    EXPECT_TRUE(repo.hasPEL(Repository::LogID{obmcID{4}}));
+}
+
+// Patch bytes in the headers of a PEL file
+TEST_F(RepositoryTest, TestPatchPEL)
+{
+    auto data = pelDataFactory(TestPELType::pelSimple);
+    auto pel = std::make_unique<PEL>(data);
+    auto pelID = pel->id();
+    Repository::LogID id{Repository::LogID::Pel{pelID}};
+
+    Repository repo{repoPath};
+    repo.add(pel);
+
+    auto path = repo.getPELAttributes(id)->get().path;
+    auto before = *repo.getPELData(id);
+
+    constexpr size_t hostStateOffset =
+        PrivateHeader::flattenedSize() + UserHeader::flattenedSize() - 1;
+    std::array<uint8_t, 1> value{
+        static_cast<uint8_t>(TransmissionState::acked)};
+
+    EXPECT_TRUE(repo.patchPEL(path, pelID, hostStateOffset, value));
+
+    // Only that byte changed.
+    auto after = *repo.getPELData(id);
+    ASSERT_EQ(after.size(), before.size());
+    before[hostStateOffset] = value[0];
+    EXPECT_EQ(after, before);
+    EXPECT_EQ(PEL{after}.hostTransmissionState(), TransmissionState::acked);
+
+    // The wrong PEL ID
+    EXPECT_FALSE(repo.patchPEL(path, pelID + 1, hostStateOffset, value));
+
+    // Past the User Header
+    EXPECT_FALSE(repo.patchPEL(path, pelID, hostStateOffset + 1, value));
+
+    // Not a PEL
+    std::ofstream{path, std::ios::trunc} << "garbage";
+    EXPECT_FALSE(repo.patchPEL(path, pelID, hostStateOffset, value));
+}
+
+TEST_F(RepositoryTest, TestAtomicWrite)
+{
+    auto data = pelDataFactory(TestPELType::pelSimple);
+    auto pel = std::make_unique<PEL>(data);
+    Repository::LogID id{Repository::LogID::Pel{pel->id()}};
+
+    Repository repo{repoPath};
+    repo.add(pel);
+    EXPECT_FALSE(repo.syncPending());
+
+    auto path = repo.getPELAttributes(id)->get().path;
+
+    // Rewrite it, which replaces the existing file.
+    EXPECT_TRUE(repo.updatePEL(path, [](PEL& pel) {
+        pel.setHMCTransmissionState(TransmissionState::acked);
+        return true;
+    }));
+
+    auto newData = *repo.getPELData(id);
+    EXPECT_EQ(PEL{newData}.hmcTransmissionState(), TransmissionState::acked);
+
+    // Only the PEL file is left behind.
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::directory_iterator{repoPath / "logs"})
+    {
+        if (entry.is_regular_file())
+        {
+            files.push_back(entry.path());
+        }
+    }
+    EXPECT_EQ(files, std::vector<fs::path>{path});
+
+    // A leftover temporary file is removed on restore.
+    std::ofstream{repoPath / "logs" / ".pel.tmp"} << "partial";
+    Repository restored{repoPath};
+    EXPECT_FALSE(fs::exists(repoPath / "logs" / ".pel.tmp"));
+    EXPECT_TRUE(restored.hasPEL(id));
+}
+
+TEST_F(RepositoryTest, TestGroupCommit)
+{
+    Repository repo{repoPath};
+    repo.setGroupCommit(true);
+
+    std::vector<Repository::LogID> ids;
+    for (int i = 0; i < 3; i++)
+    {
+        auto data = pelDataFactory(TestPELType::pelSimple);
+        auto pel = std::make_unique<PEL>(data, i + 1);
+        pel->assignID();
+        ids.emplace_back(Repository::LogID::Pel{pel->id()});
+        repo.add(pel);
+    }
+
+    // The PELs can be read before they are synced.
+    EXPECT_TRUE(repo.syncPending());
+    for (const auto& id : ids)
+    {
+        EXPECT_TRUE(repo.getPELData(id));
+    }
+
+    repo.sync();
+    EXPECT_FALSE(repo.syncPending());
+
+    // Turning it off syncs anything pending.
+    auto data = pelDataFactory(TestPELType::pelSimple);
+    auto pel = std::make_unique<PEL>(data, 4);
+    pel->assignID();
+    repo.add(pel);
+    EXPECT_TRUE(repo.syncPending());
+
+    repo.setGroupCommit(false);
+    EXPECT_FALSE(repo.syncPending());
+}
+
+TEST_F(RepositoryTest, TestSegmentStorage)
+{
+    std::vector<Repository::LogID> ids;
+    std::vector<std::vector<uint8_t>> pelData;
+
+    {
+        Repository repo{repoPath, 10000 * 20, 100,
+                        Repository::Storage::segments};
+
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            auto data = pelDataFactory(TestPELType::pelSimple);
+            auto pel = std::make_unique<PEL>(data, i + 1);
+            pel->assignID();
+            ids.emplace_back(Repository::LogID::Pel{pel->id()},
+                             Repository::LogID::Obmc{i + 1});
+            pelData.push_back(pel->data());
+            repo.add(pel);
+        }
+
+        EXPECT_EQ(*repo.getPELData(ids[0]), pelData[0]);
+        EXPECT_EQ(repo.getPELAttributes(ids[0])->get().sizeOnDisk,
+                  SegmentStore::recordHeaderSize + pelData[0].size());
+
+        // The FD is a copy of the PEL.
+        auto fd = repo.getPELFD(ids[1]);
+        ASSERT_TRUE(fd);
+        std::vector<uint8_t> fdData(pelData[1].size() + 1);
+        EXPECT_EQ(read(*fd, fdData.data(), fdData.size()),
+                  static_cast<ssize_t>(pelData[1].size()));
+        fdData.resize(pelData[1].size());
+        EXPECT_EQ(fdData, pelData[1]);
+        close(*fd);
+
+        // Change the states, which are patched in the segment.
+        repo.setPELHostTransState(ids[1].pelID.id, TransmissionState::acked);
+        repo.setPELHMCTransState(ids[2].pelID.id, TransmissionState::sent);
+
+        auto data = *repo.getPELData(ids[1]);
+        EXPECT_EQ(PEL{data}.hostTransmissionState(), TransmissionState::acked);
+
+        // A full update
+        auto path = repo.getPELAttributes(ids[2])->get().path;
+        EXPECT_TRUE(repo.updatePEL(path, [](PEL& pel) {
+            pel.setHostTransmissionState(TransmissionState::sent);
+            return true;
+        }));
+
+        EXPECT_TRUE(repo.remove(ids[0]));
+        EXPECT_FALSE(repo.getPELData(ids[0]));
+    }
+
+    // No PEL files were created.
+    for (const auto& entry : fs::directory_iterator{repoPath / "logs"})
+    {
+        EXPECT_FALSE(entry.is_regular_file()) << entry.path();
+    }
+
+    // Everything is restored from the segments, with the unacked host
+    // state reset.
+    Repository repo{repoPath, 10000 * 20, 100, Repository::Storage::segments};
+
+    EXPECT_FALSE(repo.hasPEL(ids[0]));
+    EXPECT_EQ(repo.getPELAttributes(ids[1])->get().hostState,
+              TransmissionState::acked);
+
+    const auto& attributes = repo.getPELAttributes(ids[2])->get();
+    EXPECT_EQ(attributes.hmcState, TransmissionState::sent);
+    EXPECT_EQ(attributes.hostState, TransmissionState::newPEL);
+
+    auto data = *repo.getPELData(ids[2]);
+    EXPECT_EQ(PEL{data}.hostTransmissionState(), TransmissionState::newPEL);
+}
+
+// PEL files from before segments were used are moved into them
+TEST_F(RepositoryTest, TestSegmentImport)
+{
+    std::vector<Repository::LogID> ids;
+
+    {
+        Repository repo{repoPath, 10000 * 20, 100};
+
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            auto data = pelDataFactory(TestPELType::pelSimple);
+            auto pel = std::make_unique<PEL>(data, i + 1);
+            pel->assignID();
+            ids.emplace_back(Repository::LogID::Pel{pel->id()},
+                             Repository::LogID::Obmc{i + 1});
+            repo.add(pel);
+        }
+    }
+
+    Repository repo{repoPath, 10000 * 20, 100, Repository::Storage::segments};
+
+    for (const auto& id : ids)
+    {
+        EXPECT_TRUE(repo.hasPEL(id));
+        EXPECT_TRUE(repo.getPELData(id));
+    }
+
+    EXPECT_EQ(repo.getSizeStats().total,
+              3 * repo.getPELAttributes(ids[0])->get().sizeOnDisk);
+
+    // The files are gone.
+    for (const auto& entry : fs::directory_iterator{repoPath / "logs"})
+    {
+        EXPECT_FALSE(entry.is_regular_file()) << entry.path();
+    }
+}
@@ -0,0 +1,316 @@
+// SPDX-License-Identifier: Apache-2.0
+
+#include "extensions/openpower-pels/segment_store.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+
+#include <gtest/gtest.h>
+
+using namespace openpower::pels;
+namespace fs = std::filesystem;
+
+class SegmentStoreTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char dirTemplate[] = "/tmp/segmentstoretestXXXXXX";
+        dir = mkdtemp(dirTemplate);
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(dir);
+    }
+
+    // Returns data of the size passed in, filled with the value.
+    static std::vector<uint8_t> makeData(size_t size, uint8_t value)
+    {
+        return std::vector<uint8_t>(size, value);
+    }
+
+    // Returns the segment files in the directory.
+    size_t numSegments() const
+    {
+        return std::distance(fs::directory_iterator{dir},
+                             fs::directory_iterator{});
+    }
+
+    fs::path dir;
+};
+
+TEST_F(SegmentStoreTest, AddReadRemoveTest)
+{
+    std::vector<uint8_t> data;
+
+    {
+        SegmentStore store{dir};
+
+        EXPECT_EQ(store.add(1, makeData(100, 1), true),
+                  SegmentStore::recordHeaderSize + 100);
+        store.add(2, makeData(200, 2), false);
+        store.add(3, makeData(300, 3), false);
+
+        EXPECT_TRUE(store.contains(2));
+        EXPECT_FALSE(store.contains(4));
+        EXPECT_EQ(store.ids(), (std::vector<uint32_t>{1, 2, 3}));
+
+        ASSERT_TRUE(store.read(2, data));
+        EXPECT_EQ(data, makeData(200, 2));
+        EXPECT_FALSE(store.read(4, data));
+
+        // Replace one and remove one
+        store.add(1, makeData(50, 4), false);
+        EXPECT_TRUE(store.remove(2));
+        EXPECT_FALSE(store.remove(2));
+
+        EXPECT_EQ(store.ids(), (std::vector<uint32_t>{3, 1}));
+        EXPECT_EQ(store.diskSize(1), SegmentStore::recordHeaderSize + 50);
+        EXPECT_EQ(store.diskSize(2), 0);
+    }
+
+    // The same PELs are there after reading the segments again.
+    SegmentStore store{dir};
+    EXPECT_EQ(store.ids(), (std::vector<uint32_t>{3, 1}));
+
+    ASSERT_TRUE(store.read(1, data));
+    EXPECT_EQ(data, makeData(50, 4));
+    ASSERT_TRUE(store.read(3, data));
+    EXPECT_EQ(data, makeData(300, 3));
+    EXPECT_EQ(numSegments(), 1);
+}
+
+TEST_F(SegmentStoreTest, PatchTest)
+{
+    SegmentStore store{dir};
+    store.add(1, makeData(10, 0), false);
+
+    std::vector<uint8_t> bytes{7, 8};
+    EXPECT_TRUE(store.patch(1, 8, bytes));
+    EXPECT_FALSE(store.patch(1, 9, bytes));
+    EXPECT_FALSE(store.patch(2, 0, bytes));
+
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(store.read(1, data));
+    EXPECT_EQ(data, (std::vector<uint8_t>{0, 0, 0, 0, 0, 0, 0, 0, 7, 8}));
+}
+
+TEST_F(SegmentStoreTest, GetFDTest)
+{
+    SegmentStore store{dir};
+    store.add(1, makeData(100, 5), false);
+
+    EXPECT_EQ(store.getFD(2), -1);
+
+    int fd = store.getFD(1);
+    ASSERT_NE(fd, -1);
+
+    std::vector<uint8_t> data(200);
+    EXPECT_EQ(read(fd, data.data(), data.size()), 100);
+    data.resize(100);
+    EXPECT_EQ(data, makeData(100, 5));
+
+    // It can't be changed.
+    EXPECT_EQ(pwrite(fd, data.data(), 1, 0), -1);
+    close(fd);
+}
+
+TEST_F(SegmentStoreTest, TruncatedTest)
+{
+    {
+        SegmentStore store{dir};
+        store.add(1, makeData(100, 1), true);
+        store.add(2, makeData(100, 2), true);
+    }
+
+    // Cut off the end of the last record, like a power loss would.
+    auto segment = fs::directory_iterator{dir}->path();
+    fs::resize_file(segment, fs::file_size(segment) - 10);
+
+    {
+        SegmentStore store{dir};
+        EXPECT_EQ(store.ids(), (std::vector<uint32_t>{1}));
+        EXPECT_EQ(store.totalSize(), SegmentStore::recordHeaderSize + 100);
+
+        // Appending still works.
+        store.add(3, makeData(100, 3), true);
+    }
+
+    SegmentStore store{dir};
+    EXPECT_EQ(store.ids(), (std::vector<uint32_t>{1, 3}));
+}
+
+TEST_F(SegmentStoreTest, BadDataTest)
+{
+    {
+        SegmentStore store{dir};
+        store.add(1, makeData(100, 1), true);
+        store.add(2, makeData(100, 2), true);
+        store.add(3, makeData(100, 3), true);
+
+        // Patching keeps the data CRC up to date.
+        std::vector<uint8_t> bytes{7};
+        EXPECT_TRUE(store.patch(3, 50, bytes));
+    }
+
+    // Corrupt the data of the middle record.
+    auto segment = fs::directory_iterator{dir}->path();
+    int fd = open(segment.c_str(), O_WRONLY);
+    ASSERT_NE(fd, -1);
+    uint8_t value = 0xFF;
+    EXPECT_EQ(pwrite(fd, &value, 1, 2 * SegmentStore::recordHeaderSize + 150),
+              1);
+    close(fd);
+
+    // Only that PEL is dropped.
+    SegmentStore store{dir};
+    EXPECT_EQ(store.ids(), (std::vector<uint32_t>{1, 3}));
+
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(store.read(3, data));
+    EXPECT_EQ(data[50], 7);
+}
+
+TEST_F(SegmentStoreTest, CompactTest)
+{
+    constexpr size_t segmentSize = 1000;
+    constexpr size_t recordSize = 200;
+    constexpr size_t dataSize = recordSize - SegmentStore::recordHeaderSize;
+
+    {
+        SegmentStore store{dir, segmentSize};
+
+        // 5 records per segment, so 4 segments.
+        for (uint32_t id = 1; id <= 20; id++)
+        {
+            store.add(id, makeData(dataSize, id), false);
+        }
+        EXPECT_EQ(numSegments(), 4);
+        EXPECT_EQ(store.totalSize(), 20 * recordSize);
+
+        // Remove the oldest 11, leaving one live record in the 3rd
+        // segment.
+        for (uint32_t id = 1; id <= 11; id++)
+        {
+            store.remove(id);
+        }
+
+        EXPECT_TRUE(store.compactionNeeded());
+        store.compact();
+        EXPECT_FALSE(store.compactionNeeded());
+
+        std::vector<uint8_t> data;
+        for (uint32_t id = 12; id <= 20; id++)
+        {
+            ASSERT_TRUE(store.read(id, data));
+            EXPECT_EQ(data, makeData(dataSize, id));
+        }
+
+        EXPECT_LT(store.totalSize(), 20 * recordSize);
+    }
+
+    // The removed PELs stay removed after the tombstones were dropped.
+    SegmentStore store{dir, segmentSize};
+    std::vector<uint32_t> ids;
+    for (uint32_t id = 12; id <= 20; id++)
+    {
+        ids.push_back(id);
+    }
+
+    auto restored = store.ids();
+    std::ranges::sort(restored);
+    EXPECT_EQ(restored, ids);
+}
+
+TEST_F(SegmentStoreTest, CompactSizeLimitTest)
+{
+    constexpr size_t segmentSize = 1000;
+    constexpr size_t recordSize = 200;
+    constexpr size_t dataSize = recordSize - SegmentStore::recordHeaderSize;
+
+    SegmentStore store{dir, segmentSize, 2000};
+
+    for (uint32_t id = 1; id <= 20; id++)
+    {
+        store.add(id, makeData(dataSize, id), false);
+    }
+
+    // Not enough is unused to need compacting, except that the
+    // segments are over the size limit.
+    store.remove(1);
+    store.remove(2);
+
+    EXPECT_TRUE(store.compactionNeeded());
+    store.compact();
+    EXPECT_FALSE(store.compactionNeeded());
+
+    // Only the live PELs and the tombstones in the active segment are
+    // left, which are still over the limit.
+    EXPECT_EQ(store.totalSize(),
+              18 * recordSize + 2 * SegmentStore::recordHeaderSize);
+
+    // Removing a PEL that was copied to the active segment doesn't
+    // leave anything that can be reclaimed.
+    store.remove(5);
+    EXPECT_FALSE(store.compactionNeeded());
+}
+
+TEST_F(SegmentStoreTest, UnreadableTest)
+{
+    if (geteuid() == 0)
+    {
+        GTEST_SKIP() << "File permissions don't apply to root";
+    }
+
+    constexpr size_t segmentSize = 1000;
+    constexpr size_t recordSize = 200;
+    constexpr size_t dataSize = recordSize - SegmentStore::recordHeaderSize;
+
+    {
+        SegmentStore store{dir, segmentSize};
+        for (uint32_t id = 1; id <= 10; id++)
+        {
+            store.add(id, makeData(dataSize, id), false);
+        }
+    }
+    EXPECT_EQ(numSegments(), 2);
+
+    std::vector<fs::path> files;
+    std::ranges::copy(fs::directory_iterator{dir}, std::back_inserter(files));
+    std::ranges::sort(files);
+    fs::permissions(files.front(), fs::perms::none);
+
+    {
+        SegmentStore store{dir, segmentSize};
+        EXPECT_FALSE(store.contains(1));
+        EXPECT_TRUE(store.contains(6));
+        EXPECT_EQ(store.totalSize(), 5 * recordSize);
+
+        // The segment that can be read is compacted, but the one
+        // that can't is left alone.
+        for (uint32_t id = 6; id <= 9; id++)
+        {
+            store.remove(id);
+        }
+        store.add(11, makeData(dataSize, 11), false);
+
+        EXPECT_TRUE(store.compactionNeeded());
+        store.compact();
+        EXPECT_FALSE(store.compactionNeeded());
+        EXPECT_TRUE(fs::exists(files.front()));
+    }
+
+    // Its PELs are back once it can be read again.
+    fs::permissions(files.front(), fs::perms::owner_read |
+                                       fs::perms::owner_write);
+
+    SegmentStore store{dir, segmentSize};
+    auto restored = store.ids();
+    std::ranges::sort(restored);
+    EXPECT_EQ(restored, (std::vector<uint32_t>{1, 2, 3, 4, 5, 10, 11}));
+}
@@ -86,6 +86,31 @@ TEST_F(TestJsonSerialization, testJsonProperties)
               "/xyz/openbmc_project/inventory/system/chassis");
 }
 
+TEST_F(TestJsonSerialization, testRenderJSON)
+{
+    auto id = 98;
+    std::map<std::string, std::string> testData = {{"KEY", "value"}};
+    std::string message{"render error"};
+    std::string inputPath = getEntrySerializePath(id);
+
+    auto input = std::make_unique<Entry>(
+        bus, std::string(OBJ_ENTRY) + '/' + std::to_string(id), id, 100,
+        Entry::Level::Error, std::move(message), std::move(testData),
+        AssociationList{}, "level42", inputPath, manager);
+
+    auto jsonPath = serializeJSON(*input);
+    std::ifstream is(jsonPath);
+    std::string fileContents{std::istreambuf_iterator<char>(is),
+                             std::istreambuf_iterator<char>()};
+
+    EXPECT_EQ(renderJSON(*input), fileContents);
+
+    nlohmann::json j = nlohmann::json::parse(renderJSON(*input));
+    EXPECT_EQ(j["id"].get<uint32_t>(), 98);
+    EXPECT_EQ(j["message"].get<std::string>(), "render error");
+    EXPECT_EQ(j["additionalData"]["KEY"].get<std::string>(), "value");
+}
+
 TEST_F(TestJsonSerialization, testJsonEmptyAdditionalData)
 {
     auto id = 50;
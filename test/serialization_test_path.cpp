@@ -2,6 +2,8 @@
 #include "elog_serialize.hpp"
 #include "serialization_tests.hpp"
 
+#include <vector>
+
 namespace phosphor
 {
 namespace logging
@@ -18,6 +20,26 @@ TEST_F(TestSerialization, testPath)
     EXPECT_EQ(path.c_str(), TestSerialization::dir / std::to_string(id));
 }
 
+TEST_F(TestSerialization, testNoTempFileLeft)
+{
+    auto id = 98;
+    auto e = std::make_unique<Entry>(
+        bus, std::string(OBJ_ENTRY) + '/' + std::to_string(id), id, manager);
+
+    // Write it twice so the second write replaces the first.
+    serialize(*e, TestSerialization::dir);
+    auto path = serialize(*e, TestSerialization::dir);
+
+    std::vector<fs::path> files;
+    for (const auto& file : fs::directory_iterator(TestSerialization::dir))
+    {
+        files.push_back(file.path());
+    }
+
+    ASSERT_EQ(files.size(), 1);
+    EXPECT_EQ(files[0], path);
+}
+
 } // namespace test
 } // namespace logging
 } // namespace phosphor
@@ -1,6 +1,8 @@
 // SPDX-License-Identifier: Apache-2.0
 // SPDX-FileCopyrightText: Copyright 2020 IBM Corporation
 
+#include "config.h"
+
 #include "util.hpp"
 
 #include "constants.hpp"
@@ -8,13 +10,16 @@
 #include <poll.h>
 #include <sys/inotify.h>
 #include <systemd/sd-bus.h>
+#include <systemd/sd-event.h>
 #include <systemd/sd-journal.h>
 #include <unistd.h>
 
 #include <phosphor-logging/lg2.hpp>
 #include <sdbusplus/bus.hpp>
 
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <fstream>
 
 namespace phosphor::logging::util
@@ -43,18 +48,59 @@ std::optional<std::string> getOSReleaseValue(const std::string& key)
     return std::nullopt;
 }
 
-void journalSync()
+namespace
+{
+
+/** @brief Monotonic time (usec) the last successful sync was started at */
+uint64_t lastSyncStart = 0;
+
+/** @brief Counters for the journal syncs done by this process */
+JournalSyncStats syncStats{};
+
+/**
+ * @brief Returns the monotonic time (usec) that the default event loop woke
+ *        up for the dispatch currently in progress.
+ *
+ * @param[in] now - The value to return when not inside a dispatch
+ *
+ * @return uint64_t - The dispatch start time
+ */
+uint64_t getDispatchTime(uint64_t now)
+{
+    sd_event* event = nullptr;
+    uint64_t dispatchTime = now;
+
+    if (sd_event_default(&event) < 0)
+    {
+        return now;
+    }
+
+    if ((sd_event_get_state(event) != SD_EVENT_RUNNING) ||
+        (sd_event_now(event, CLOCK_MONOTONIC, &dispatchTime) < 0))
+    {
+        dispatchTime = now;
+    }
+
+    sd_event_unref(event);
+    return dispatchTime;
+}
+
+/**
+ * @brief Requests a journal sync and waits for it to complete.
+ *
+ * @param[in] start - The monotonic time (usec) the request was made at
+ *
+ * @return bool - true if journald reported a sync newer than start
+ */
+bool requestSync(uint64_t start)
 {
     bool syncRequested = false;
+    bool synced = false;
     auto fd = -1;
     auto rc = -1;
     auto wd = -1;
     auto bus = sdbusplus::bus::new_default();
 
-    auto start = std::chrono::duration_cast<std::chrono::microseconds>(
-                     std::chrono::steady_clock::now().time_since_epoch())
-                     .count();
-
     // Make a request to sync the journal with the SIGRTMIN+1 signal and
     // block until it finishes, waiting at most 5 seconds.
     //
@@ -80,7 +126,7 @@ void journalSync()
                 lg2::error(
                     "Failed to open journal synced file {FILENAME}: {ERROR}",
                     "FILENAME", syncedPath, "ERROR", strerror(errno));
-                return;
+                return false;
             }
         }
         else
@@ -90,8 +136,9 @@ void journalSync()
             std::string timestampStr;
             std::getline(syncedFile, timestampStr);
             auto timestamp = std::stoll(timestampStr);
-            if (timestamp >= start)
+            if (timestamp >= static_cast<int64_t>(start))
             {
+                synced = true;
                 break;
             }
         }
@@ -130,7 +177,7 @@ void journalSync()
             {
                 lg2::error("Failed to create inotify watch: {ERROR}", "ERROR",
                            strerror(errno));
-                return;
+                return false;
             }
 
             constexpr auto JOURNAL_RUN_PATH = "/run/systemd/journal";
@@ -141,7 +188,7 @@ void journalSync()
                 lg2::error("Failed to watch journal directory: {PATH}: {ERROR}",
                            "PATH", JOURNAL_RUN_PATH, "ERROR", strerror(errno));
                 close(fd);
-                return;
+                return false;
             }
             continue;
         }
@@ -160,7 +207,7 @@ void journalSync()
                        strerror(errno));
             inotify_rm_watch(fd, wd);
             close(fd);
-            return;
+            return false;
         }
         else if (rc == 0)
         {
@@ -176,6 +223,9 @@ void journalSync()
         uint8_t buffer[maxBytes];
         while (read(fd, buffer, maxBytes) > 0)
             ;
+
+        // The synced file was just rewritten by journald.
+        synced = true;
     }
 
     if (fd != -1)
@@ -187,7 +237,132 @@ void journalSync()
         close(fd);
     }
 
-    return;
+    return synced;
+}
+
+} // namespace
+
+void journalSync()
+{
+    auto start = std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::steady_clock::now().time_since_epoch())
+                     .count();
+
+    syncStats.requests++;
+
+    // A client logs its journal metadata before making the D-Bus call that
+    // is being handled, so a sync started after this dispatch began already
+    // covers it.  This lets a commit and the extensions it calls into share
+    // a single flush.
+    if ((lastSyncStart != 0) &&
+        (lastSyncStart >= getDispatchTime(static_cast<uint64_t>(start))))
+    {
+        syncStats.coalesced++;
+        return;
+    }
+
+    // Unit tests can't ask journald to sync, so act as if it did.
+    auto synced = IS_UNIT_TEST || requestSync(static_cast<uint64_t>(start));
+
+    auto end = std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+                   .count();
+    auto latency = static_cast<uint64_t>(end - start);
+
+    syncStats.totalLatency += latency;
+    syncStats.maxLatency = std::max(syncStats.maxLatency, latency);
+
+    if (synced)
+    {
+        lastSyncStart = static_cast<uint64_t>(start);
+    }
+    else
+    {
+        syncStats.failures++;
+    }
+}
+
+const JournalSyncStats& getJournalSyncStats()
+{
+    return syncStats;
+}
+
+std::optional<std::map<std::string, std::string>>
+    readTransactionData(uint64_t transactionId, std::set<std::string>& fields)
+{
+    sd_journal* j = nullptr;
+    int rc = sd_journal_open(&j, SD_JOURNAL_LOCAL_ONLY);
+    if (rc < 0)
+    {
+        lg2::error("Failed to open journal: {ERROR}", "ERROR", strerror(-rc));
+        return std::nullopt;
+    }
+
+    std::map<std::string, std::string> values;
+
+    // Let journald's field index select the entries for this transaction
+    // instead of walking every entry in the journal and comparing the
+    // TRANSACTION_ID field of each one.
+    auto match = "TRANSACTION_ID=" + std::to_string(transactionId);
+    rc = sd_journal_add_match(j, match.c_str(), 0);
+    if (rc < 0)
+    {
+        lg2::error("Failed to add journal match {MATCH}: {ERROR}", "MATCH",
+                   match, "ERROR", strerror(-rc));
+        sd_journal_close(j);
+        return std::nullopt;
+    }
+
+    // A transaction only writes a handful of journal entries, so bound
+    // the search in case the ID has somehow been reused many times.
+    constexpr size_t maxTransactionEntries = 64;
+    size_t entriesChecked = 0;
+
+    // Read the journal from the end to get the most recent entry first.
+    // The result from the sd_journal_get_data() is of the form
+    // VARIABLE=value.
+    SD_JOURNAL_FOREACH_BACKWARDS(j)
+    {
+        if (entriesChecked++ == maxTransactionEntries)
+        {
+            break;
+        }
+
+        // Search for all metadata variables in the current journal entry.
+        for (auto i = fields.cbegin(); i != fields.cend();)
+        {
+            const char* data = nullptr;
+            size_t length = 0;
+
+            rc = sd_journal_get_data(j, (*i).c_str(), (const void**)&data,
+                                     &length);
+            if (rc < 0)
+            {
+                // Metadata variable not found, check next metadata
+                // variable.
+                i++;
+                continue;
+            }
+
+            // Metadata variable found, save it and remove it from the set.
+            std::string metadata(data, length);
+            if (auto pos = metadata.find('='); pos != std::string::npos)
+            {
+                auto key = metadata.substr(0, pos);
+                auto value = metadata.substr(pos + 1);
+                values.emplace(std::move(key), std::move(value));
+            }
+            i = fields.erase(i);
+        }
+        if (fields.empty())
+        {
+            // All metadata variables found, break out of journal loop.
+            break;
+        }
+    }
+
+    sd_journal_close(j);
+    return values;
 }
 
 bool setupInotifyWatch(const std::string& path, uint32_t mask, int& inotifyFD,
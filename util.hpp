@@ -5,6 +5,7 @@
 #include <cstdint>
 #include <map>
 #include <optional>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -20,13 +21,62 @@ namespace phosphor::logging::util
  */
 std::optional<std::string> getOSReleaseValue(const std::string& key);
 
+/**
+ * @brief Statistics on the journal syncs requested through journalSync()
+ */
+struct JournalSyncStats
+{
+    /** @brief Number of calls to journalSync() */
+    uint64_t requests = 0;
+
+    /** @brief Number of calls satisfied by an earlier sync */
+    uint64_t coalesced = 0;
+
+    /** @brief Number of syncs that failed or timed out */
+    uint64_t failures = 0;
+
+    /** @brief Total time spent waiting for syncs, in microseconds */
+    uint64_t totalLatency = 0;
+
+    /** @brief Longest time spent waiting for a sync, in microseconds */
+    uint64_t maxLatency = 0;
+};
+
 /**
  * @brief Synchronize unwritten journal messages to disk.
  * @details This is the same implementation as the systemd command
  *          "journalctl --sync".
+ *
+ *          When called from inside a dispatch of the default sd_event
+ *          loop, a sync that was already requested during the same
+ *          dispatch is reused instead of flushing the journal again.
  */
 void journalSync();
 
+/**
+ * @brief Returns the journal sync statistics for this process
+ *
+ * @return const JournalSyncStats& - The statistics
+ */
+const JournalSyncStats& getJournalSyncStats();
+
+/**
+ * @brief Read the metadata of a transaction from the journal
+ * @details Uses a match on the TRANSACTION_ID field so that journald's
+ *          field index finds the transaction's entries, instead of
+ *          walking the whole journal.  The most recent value of each
+ *          field is used.
+ *
+ * @param[in] transactionId - The TRANSACTION_ID the metadata was logged with
+ * @param[in,out] fields - The names of the fields to read.  The ones found
+ *                         are removed.
+ *
+ * @return The field values found, or std::nullopt if the journal couldn't
+ *         be read
+ */
+std::optional<std::map<std::string, std::string>>
+    readTransactionData(uint64_t transactionId, std::set<std::string>& fields);
+
 /**
  * @brief Set up an inotify watch on a directory
  *